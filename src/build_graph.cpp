@@ -0,0 +1,203 @@
+#include "build_graph.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace buildGraph {
+
+size_t ImportGraph::addFile(const std::filesystem::path& relative) {
+    auto key = relative.lexically_normal().string();
+    if (auto it = index.find(key); it != index.end()) { return it->second; }
+    nodes.push_back({relative.lexically_normal()});
+    index[key] = nodes.size() - 1;
+    return nodes.size() - 1;
+}
+
+std::optional<size_t> ImportGraph::find(const std::filesystem::path& relative) const {
+    auto it = index.find(relative.lexically_normal().string());
+    if (it == index.end()) return std::nullopt;
+    return it->second;
+}
+
+void ImportGraph::addImport(size_t importer, size_t imported) {
+    auto& imports = nodes[importer].imports;
+    if (std::find(imports.begin(), imports.end(), imported) != imports.end()) return;
+    imports.push_back(imported);
+    nodes[imported].importers.push_back(importer);
+}
+
+void ImportGraph::computePriorities() {
+    // Kahn's algorithm over importer edges, starting from files nobody imports.
+    // Nodes left over sit on a cycle and keep priority 0.
+    std::vector<size_t> unresolved(nodes.size());
+    std::vector<size_t> queue;
+    for (size_t idx = 0; idx < nodes.size(); ++idx) {
+        nodes[idx].priority = 0;
+        unresolved[idx] = nodes[idx].importers.size();
+        if (unresolved[idx] == 0) queue.push_back(idx);
+    }
+    while (!queue.empty()) {
+        size_t idx = queue.back();
+        queue.pop_back();
+        for (size_t imported : nodes[idx].imports) {
+            nodes[imported].priority = std::max(nodes[imported].priority, nodes[idx].priority + 1);
+            if (--unresolved[imported] == 0) queue.push_back(imported);
+        }
+    }
+}
+
+std::vector<std::vector<size_t>> ImportGraph::cycles() const {
+    // Tarjan's algorithm, with an explicit stack so deep import chains cannot overflow it
+    constexpr size_t UNVISITED = SIZE_MAX;
+    std::vector<size_t> order(nodes.size(), UNVISITED);
+    std::vector<size_t> lowlink(nodes.size(), 0);
+    std::vector<bool> onStack(nodes.size(), false);
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, size_t>> calls; // Node & index of the next import to visit
+    std::vector<std::vector<size_t>> found;
+    size_t counter = 0;
+
+    for (size_t root = 0; root < nodes.size(); ++root) {
+        if (order[root] != UNVISITED) continue;
+        calls.emplace_back(root, 0);
+        while (!calls.empty()) {
+            auto& [idx, next] = calls.back();
+            if (next == 0) {
+                order[idx] = lowlink[idx] = counter++;
+                stack.push_back(idx);
+                onStack[idx] = true;
+            }
+            if (next < nodes[idx].imports.size()) {
+                size_t imported = nodes[idx].imports[next++];
+                if (order[imported] == UNVISITED) calls.emplace_back(imported, 0);
+                else if (onStack[imported]) lowlink[idx] = std::min(lowlink[idx], order[imported]);
+                continue;
+            }
+
+            size_t done = idx;
+            calls.pop_back();
+            if (!calls.empty()) lowlink[calls.back().first] = std::min(lowlink[calls.back().first], lowlink[done]);
+            if (lowlink[done] != order[done]) continue;
+            std::vector<size_t> component;
+            size_t member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = false;
+                component.push_back(member);
+            } while (member != done);
+            const auto& imports = nodes[done].imports;
+            bool selfImport = std::find(imports.begin(), imports.end(), done) != imports.end();
+            if (component.size() > 1 || selfImport) {
+                std::sort(component.begin(), component.end());
+                found.push_back(std::move(component));
+            }
+        }
+    }
+    return found;
+}
+
+std::string ImportGraph::describeCycle(const std::vector<size_t>& cycle) const {
+    // Shortest way back to the first file, searched breadth first inside the cycle
+    size_t start = cycle.front();
+    std::unordered_map<size_t, size_t> via; // File -> the file importing it on the way
+    std::vector<size_t> queue = {start};
+    bool closed = false;
+    for (size_t head = 0; head < queue.size() && !closed; ++head) {
+        for (size_t imported : nodes[queue[head]].imports) {
+            if (!std::binary_search(cycle.begin(), cycle.end(), imported)) continue;
+            if (imported == start) {
+                via[start] = queue[head];
+                closed = true;
+                break;
+            }
+            if (via.try_emplace(imported, queue[head]).second) queue.push_back(imported);
+        }
+    }
+
+    std::vector<size_t> chain = {start};
+    for (size_t idx = via[start]; idx != start; idx = via[idx]) chain.push_back(idx);
+    chain.push_back(start);
+    std::reverse(chain.begin() + 1, chain.end() - 1);
+
+    std::string description;
+    for (size_t idx : chain) description += (description.empty() ? "" : " -> ") + nodes[idx].relative.string();
+    std::string others;
+    for (size_t idx : cycle) {
+        if (std::find(chain.begin(), chain.end(), idx) == chain.end()) others += (others.empty() ? "" : ", ") + nodes[idx].relative.string();
+    }
+    if (!others.empty()) description += " (also on the cycle: " + others + ")";
+    return description;
+}
+
+void ImportGraph::collapseCycles(const std::vector<std::vector<size_t>>& cycles) {
+    for (const auto& cycle : cycles) {
+        auto inCycle = [&cycle](size_t idx) { return std::binary_search(cycle.begin(), cycle.end(), idx); };
+        std::vector<size_t> external;
+        for (size_t member : cycle) {
+            for (size_t imported : nodes[member].imports) {
+                if (!inCycle(imported)) external.push_back(imported);
+            }
+            std::erase_if(nodes[member].imports, inCycle);
+            std::erase_if(nodes[member].importers, inCycle);
+        }
+        for (size_t member : cycle) {
+            for (size_t imported : external) addImport(member, imported);
+        }
+    }
+}
+
+std::vector<std::filesystem::path> collectImports(AST::Program* program, const std::filesystem::path& relative) {
+    std::vector<std::filesystem::path> imports;
+    for (auto stmt : program->statements) {
+        if (stmt->type() != AST::NodeType::ImportStatement) continue;
+        auto import_statement = stmt->castToImportStatement();
+        imports.push_back((relative.parent_path() / (import_statement->relativePath + ".gc")).lexically_normal());
+    }
+    return imports;
+}
+
+std::vector<size_t> BuildScheduler::run(const std::function<void(size_t)>& build) {
+    auto remaining = std::make_unique<std::atomic<size_t>[]>(graph.size());
+    auto started = std::make_unique<std::atomic<bool>[]>(graph.size());
+
+    auto byPriority = [this](size_t a, size_t b) { return graph[a].priority < graph[b].priority; };
+
+    // Lower priority first: workers pop their own deque from the back, so the
+    // most important ready file is picked up next.
+    std::function<void(std::vector<size_t>&)> submitReady;
+    std::function<void(size_t)> task = [&](size_t idx) {
+        started[idx] = true;
+        build(idx);
+        std::vector<size_t> ready;
+        for (size_t importer : graph[idx].importers) {
+            if (--remaining[importer] == 0) ready.push_back(importer);
+        }
+        submitReady(ready);
+    };
+    submitReady = [&](std::vector<size_t>& ready) {
+        std::sort(ready.begin(), ready.end(), byPriority);
+        for (size_t idx : ready) {
+            pool.submit([&task, idx]() { task(idx); });
+        }
+    };
+
+    std::vector<size_t> ready;
+    for (size_t idx = 0; idx < graph.size(); ++idx) {
+        remaining[idx] = graph[idx].imports.size();
+        started[idx] = false;
+        if (remaining[idx] == 0) ready.push_back(idx);
+    }
+    submitReady(ready);
+    pool.wait();
+
+    std::vector<size_t> never_started;
+    for (size_t idx = 0; idx < graph.size(); ++idx) {
+        if (!started[idx]) never_started.push_back(idx);
+    }
+    return never_started;
+}
+
+} // namespace buildGraph
@@ -0,0 +1,136 @@
+#ifndef BUILD_GRAPH_HPP
+#define BUILD_GRAPH_HPP
+
+/**
+ * @file build_graph.hpp
+ * @brief Import dependency graph and the DAG scheduler used by `gigly`.
+ *
+ * The driver parses every source once, records the `import` statements of each
+ * file as edges of an ImportGraph and then hands the graph to BuildScheduler,
+ * which only starts a file once everything it imports has been compiled. This
+ * lets a fixed number of workers compile a whole project without any worker
+ * blocking on an import. Import cycles are found up front and collapsed, so
+ * their files can be declared first and then compiled side by side.
+ */
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "parser/AST/ast.hpp"
+#include "thread_pool.hpp"
+
+namespace buildGraph {
+
+/**
+ * @struct ImportNode
+ * @brief One source file of the project.
+ */
+struct ImportNode {
+    std::filesystem::path relative; ///< Path relative to the source directory
+    std::vector<size_t> imports;    ///< Files imported by this file
+    std::vector<size_t> importers;  ///< Files importing this file
+    size_t priority = 0;            ///< Length of the longest importer chain waiting on this file
+};
+
+/**
+ * @class ImportGraph
+ * @brief Directed graph of `import` edges between the files of a project.
+ */
+class ImportGraph {
+  public:
+    /**
+     * @brief Adds a file, or returns the existing node for it.
+     * @param relative Path of the file relative to the source directory.
+     * @return Index of the node.
+     */
+    size_t addFile(const std::filesystem::path& relative);
+
+    /**
+     * @brief Looks up the node of a file.
+     */
+    std::optional<size_t> find(const std::filesystem::path& relative) const;
+
+    /**
+     * @brief Records that `importer` imports `imported`.
+     */
+    void addImport(size_t importer, size_t imported);
+
+    /**
+     * @brief Computes ImportNode::priority for every node.
+     *
+     * Files at the bottom of long import chains get the highest priority so
+     * the scheduler starts them first.
+     */
+    void computePriorities();
+
+    /**
+     * @brief Finds the import cycles: strongly connected components of two or more files, or a file importing itself.
+     * @return The files of every cycle, each list in ascending order.
+     */
+    std::vector<std::vector<size_t>> cycles() const;
+
+    /**
+     * @brief Describes a cycle as an import chain, e.g. `a.gc -> b.gc -> a.gc`.
+     *
+     * Files of the cycle the chain does not pass through are listed after it.
+     */
+    std::string describeCycle(const std::vector<size_t>& cycle) const;
+
+    /**
+     * @brief Drops the imports inside every cycle; each file of a cycle imports what the whole cycle imports instead.
+     *
+     * Leaves a DAG the scheduler can run: the files of a cycle become ready
+     * together, once everything the cycle depends on is done. They are
+     * expected to be declared first (see RecordFile::markDeclared).
+     */
+    void collapseCycles(const std::vector<std::vector<size_t>>& cycles);
+
+    const ImportNode& operator[](size_t idx) const { return nodes[idx]; }
+    size_t size() const { return nodes.size(); }
+
+  private:
+    std::vector<ImportNode> nodes;
+    std::unordered_map<std::string, size_t> index;
+};
+
+/**
+ * @brief Resolves the top-level import statements of a program.
+ *
+ * Imports are resolved relative to the directory of the importing file, the
+ * same way `compiler::Compiler::_visitImportStatement` resolves them.
+ *
+ * @param program The parsed program.
+ * @param relative Path of the program relative to the source directory.
+ * @return Imported files relative to the source directory.
+ */
+std::vector<std::filesystem::path> collectImports(AST::Program* program, const std::filesystem::path& relative);
+
+/**
+ * @class BuildScheduler
+ * @brief Runs one task per ImportGraph node in dependency order on a ThreadPool.
+ */
+class BuildScheduler {
+  public:
+    BuildScheduler(const ImportGraph& graph, ThreadPool& pool) : graph(graph), pool(pool) {}
+
+    /**
+     * @brief Calls `build` for every node once all of its imports have finished.
+     *
+     * Exceptions thrown by `build` are rethrown once the pool has drained.
+     *
+     * @return Nodes that never became ready because they sit on an import cycle.
+     */
+    std::vector<size_t> run(const std::function<void(size_t)>& build);
+
+  private:
+    const ImportGraph& graph;
+    ThreadPool& pool;
+};
+
+} // namespace buildGraph
+
+#endif // BUILD_GRAPH_HPP
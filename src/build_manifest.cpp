@@ -0,0 +1,127 @@
+#include "build_manifest.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <sstream>
+#include <yaml-cpp/yaml.h>
+
+#include "compilation_state.hpp"
+
+namespace compilationState {
+
+// Bump whenever the layout of the manifest changes
+static constexpr int MANIFEST_VERSION = 3;
+
+static std::string hashToString(uint64_t hash) {
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return stream.str();
+}
+
+static uint64_t hashFromString(const std::string& text) {
+    return std::stoull(text, nullptr, 16);
+}
+
+bool ManifestEntry::sameInputs(const ManifestEntry& other) const {
+    return source_hash == other.source_hash && compiler_id == other.compiler_id && target_triple == other.target_triple && optimization_level == other.optimization_level &&
+           pass_pipeline == other.pass_pipeline && lto == other.lto && imports_hash == other.imports_hash;
+}
+
+const std::string& BuildManifest::compilerId() {
+    static const std::string id = []() {
+        // Size and modification time of the gigly binary stand in for a build id
+        std::string executable = llvm::sys::fs::getMainExecutable(nullptr, reinterpret_cast<void*>(&BuildManifest::compilerId));
+        std::string stamp = "llvm-" LLVM_VERSION_STRING;
+        std::error_code ec;
+        auto size = std::filesystem::file_size(executable, ec);
+        if (!ec) stamp += ":" + std::to_string(size);
+        auto mtime = std::filesystem::last_write_time(executable, ec);
+        if (!ec) stamp += ":" + std::to_string(mtime.time_since_epoch().count());
+        return "gigly-" + hashToString(Utils::computeHash(stamp));
+    }();
+    return id;
+}
+
+void BuildManifest::load(const std::filesystem::path& path) {
+    entries.clear();
+    link_hash = 0;
+    if (!std::filesystem::exists(path)) return;
+    try {
+        YAML::Node root = YAML::LoadFile(path.string());
+        if (!root["version"] || root["version"].as<int>() != MANIFEST_VERSION) return;
+        if (root["link_hash"]) link_hash = hashFromString(root["link_hash"].as<std::string>());
+        for (const auto& file : root["files"]) {
+            ManifestEntry entry;
+            entry.source_hash = hashFromString(file["source_hash"].as<std::string>());
+            entry.compiler_id = file["compiler"].as<std::string>();
+            entry.target_triple = file["target"].as<std::string>();
+            entry.optimization_level = file["optimization"].as<std::string>();
+            entry.pass_pipeline = file["passes"].as<std::string>();
+            entry.lto = file["lto"].as<std::string>();
+            entry.imports_hash = hashFromString(file["imports_hash"].as<std::string>());
+            entry.interface_hash = hashFromString(file["interface_hash"].as<std::string>());
+            entry.object_stamp = file["object_stamp"].as<int64_t>();
+            for (const auto& imported : file["imports"]) entry.imports.push_back(imported.as<std::string>());
+            entries[file["path"].as<std::string>()] = std::move(entry);
+        }
+    } catch (const std::exception&) {
+        // A corrupt manifest only costs a full rebuild
+        entries.clear();
+        link_hash = 0;
+    }
+}
+
+void BuildManifest::save(const std::filesystem::path& path) const {
+    // Sorted so the manifest is stable between runs
+    std::vector<const std::pair<const std::string, ManifestEntry>*> sorted;
+    for (const auto& entry : entries) sorted.push_back(&entry);
+    std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->first < b->first; });
+
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "version" << YAML::Value << MANIFEST_VERSION;
+    out << YAML::Key << "link_hash" << YAML::Value << hashToString(link_hash);
+    out << YAML::Key << "files" << YAML::Value << YAML::BeginSeq;
+    for (const auto* item : sorted) {
+        const auto& entry = item->second;
+        out << YAML::BeginMap;
+        out << YAML::Key << "path" << YAML::Value << item->first;
+        out << YAML::Key << "source_hash" << YAML::Value << hashToString(entry.source_hash);
+        out << YAML::Key << "compiler" << YAML::Value << entry.compiler_id;
+        out << YAML::Key << "target" << YAML::Value << entry.target_triple;
+        out << YAML::Key << "optimization" << YAML::Value << entry.optimization_level;
+        out << YAML::Key << "passes" << YAML::Value << entry.pass_pipeline;
+        out << YAML::Key << "lto" << YAML::Value << entry.lto;
+        out << YAML::Key << "imports_hash" << YAML::Value << hashToString(entry.imports_hash);
+        out << YAML::Key << "interface_hash" << YAML::Value << hashToString(entry.interface_hash);
+        out << YAML::Key << "object_stamp" << YAML::Value << entry.object_stamp;
+        out << YAML::Key << "imports" << YAML::Value << YAML::Flow << entry.imports;
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file) {
+            std::cerr << "Warning: could not write build manifest " << path.string() << std::endl;
+            return;
+        }
+        file << out.c_str() << "\n";
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+}
+
+const ManifestEntry* BuildManifest::find(const std::string& relative) const {
+    auto it = entries.find(relative);
+    return it == entries.end() ? nullptr : &it->second;
+}
+
+} // namespace compilationState
@@ -0,0 +1,95 @@
+#ifndef BUILD_MANIFEST_HPP
+#define BUILD_MANIFEST_HPP
+
+/**
+ * @file build_manifest.hpp
+ * @brief Persistent record of what `gigly` built, used for incremental builds.
+ *
+ * The manifest lives in `build/manifest.yaml` and stores, for every source
+ * file, everything its object depends on: the source hash, the compiler that
+ * produced it, the target triple, the optimization settings and a combined
+ * hash of the interfaces of every file it imports (transitively). A file whose
+ * entry still matches is not lexed, parsed or compiled again.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace compilationState {
+
+/**
+ * @struct ManifestEntry
+ * @brief Inputs that produced the object of one source file.
+ */
+struct ManifestEntry {
+    uint64_t source_hash = 0;
+    std::string compiler_id;
+    std::string target_triple;
+    std::string optimization_level;
+    std::string pass_pipeline;
+    std::string lto;                  ///< `--lto` mode; the artifact is bitcode when set
+    std::vector<std::string> imports; ///< Direct imports, relative to the source directory
+    uint64_t imports_hash = 0;        ///< Combined interface hash of every transitively imported file
+    uint64_t interface_hash = 0;      ///< Hash of the module interface this file exported
+    int64_t object_stamp = 0;         ///< Modification time of the object when it was recorded
+
+    /**
+     * @brief Whether both entries describe the same object.
+     *
+     * Only the inputs are compared, not `imports` or the recorded outputs.
+     */
+    bool sameInputs(const ManifestEntry& other) const;
+};
+
+/**
+ * @class BuildManifest
+ * @brief The set of ManifestEntry of a build directory.
+ */
+class BuildManifest {
+  public:
+    /**
+     * @brief Identifies the running compiler build.
+     *
+     * Changes whenever gigly is rebuilt or linked against another LLVM, so a
+     * new compiler never reuses objects of an old one.
+     */
+    static const std::string& compilerId();
+
+    /**
+     * @brief Loads a manifest; a missing, unreadable or outdated file yields an empty manifest.
+     */
+    void load(const std::filesystem::path& path);
+
+    /**
+     * @brief Writes the manifest atomically (write to a temporary file, then rename).
+     */
+    void save(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Looks up the entry of a file.
+     * @param relative Path relative to the source directory.
+     * @return The entry, or nullptr if the file was never built.
+     */
+    const ManifestEntry* find(const std::string& relative) const;
+
+    void set(const std::string& relative, ManifestEntry entry) { entries[relative] = std::move(entry); }
+
+    /**
+     * @brief Every entry, keyed by path relative to the source directory.
+     */
+    const std::unordered_map<std::string, ManifestEntry>& all() const { return entries; }
+
+    void clear() { entries.clear(); }
+
+    uint64_t link_hash = 0; ///< Hash of the inputs of the last successful link
+
+  private:
+    std::unordered_map<std::string, ManifestEntry> entries;
+};
+
+} // namespace compilationState
+
+#endif // BUILD_MANIFEST_HPP
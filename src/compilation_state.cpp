@@ -1,18 +1,29 @@
 #include "compilation_state.hpp"
 #include "errors/errors.hpp"
+#include "lexer/lexer.hpp"
+#include "parser/parser.hpp"
+#include "time_trace.hpp"
 #include <array>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <iostream>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/xxhash.h>
 #include <mutex>
 #include <sstream>
+#include <sys/wait.h>
 #include <system_error>
+#include <unistd.h>
 
 // =======================================
 // Helper Function to Run External Commands
 // =======================================
 std::string runCommand(const std::string& command, int& exit_code) {
+    timeTrace::Scope trace("Run tool", command);
     std::array<char, 128> buffer;
     std::string result;
 
@@ -38,6 +49,21 @@ std::string runCommand(const std::string& command, int& exit_code) {
 // =======================================
 namespace Utils {
 
+int runInChild(const std::function<int()>& run) {
+    // Anything still buffered would be written by both processes
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    pid_t child = fork();
+    if (child == 0) std::exit(run());
+    if (child < 0) errors::raiseCompilationError(std::string("Could not fork: ") + std::strerror(errno));
+
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
 std::string readFileToString(const std::filesystem::path& filePath) {
     std::ifstream file(filePath, std::ios::in | std::ios::binary);
     if (!file) { errors::raiseFileNotFoundError("Error: Could not open file " + filePath.string()); }
@@ -46,8 +72,9 @@ std::string readFileToString(const std::filesystem::path& filePath) {
     return buffer.str();
 }
 
-size_t computeHash(const std::string& content) {
-    return std::hash<std::string>{}(content);
+uint64_t computeHash(const std::string& content) {
+    // xxh3 is stable across runs and platforms, unlike std::hash, so it can be persisted
+    return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(content));
 }
 
 void createDirectories(const std::filesystem::path& path) {
@@ -60,42 +87,185 @@ void createDirectories(const std::filesystem::path& path) {
 } // namespace Utils
 
 // =======================================
-// Global File Record Helper
+// File Record State
 // =======================================
-static std::mutex fileRecordMutex;
+namespace compilationState {
 
-compilationState::RecordFile* findOrCreateFileRecord(compilationState::RecordFolder* rootFolder, const std::filesystem::path& relativePath) {
-    std::lock_guard<std::mutex> lock(fileRecordMutex);
-    compilationState::RecordFolder* currentFolder = rootFolder;
-    for (const auto& part : relativePath.parent_path()) {
-        bool found = false;
-        for (auto& item : currentFolder->files_or_folder) {
-            if (auto folder = std::get_if<compilationState::RecordFolder*>(&item)) {
-                if ((*folder)->name == part.string()) {
-                    currentFolder = *folder;
-                    found = true;
-                    break;
-                }
+RecordFile::State RecordFile::getState() const {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    return state;
+}
+
+bool RecordFile::tryStart() {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    if (state != State::Pending) return false;
+    state = State::InProgress;
+    return true;
+}
+
+void RecordFile::markDeclared() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        declared = true;
+    }
+    state_cv.notify_all();
+}
+
+void RecordFile::markDone() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        state = State::Done;
+    }
+    state_cv.notify_all();
+}
+
+void RecordFile::markFailed(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        state = State::Failed;
+        failure_message = message;
+    }
+    state_cv.notify_all();
+}
+
+RecordFile::State RecordFile::wait() {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    state_cv.wait(lock, [this]() { return declared || state == State::Done || state == State::Failed; });
+    return state;
+}
+
+std::string RecordFile::failureMessage() const {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    return failure_message;
+}
+
+// =======================================
+// Shared AST Cache
+// =======================================
+ASTCache::~ASTCache() {
+    for (auto& [path, slot] : programs) delete slot->program;
+    for (auto& [path, slot] : interfaces) delete slot->program;
+}
+
+ASTCache::Slot& ASTCache::slot(SlotMap& slots, const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(slots_mutex);
+    auto& entry = slots[std::filesystem::absolute(path).lexically_normal().string()];
+    if (!entry) entry = std::make_unique<Slot>();
+    return *entry;
+}
+
+ASTCache::FileStamp ASTCache::stampOf(const std::filesystem::path& path) {
+    std::error_code ec;
+    FileStamp stamp;
+    stamp.time = std::filesystem::last_write_time(path, ec);
+    if (ec) return {};
+    stamp.size = std::filesystem::file_size(path, ec);
+    return stamp;
+}
+
+const std::string& ASTCache::source(const std::filesystem::path& path) {
+    Slot& entry = slot(sources, path);
+    std::lock_guard<std::mutex> lock(entry.mutex);
+    if (!entry.loaded) {
+        timeTrace::Scope trace("Read", path.string());
+        // Taken before reading, so a write during the read makes the entry stale
+        entry.stamp = stampOf(path);
+        entry.source = Utils::readFileToString(path);
+        entry.loaded = true;
+    }
+    return entry.source;
+}
+
+AST::Program* ASTCache::program(const std::filesystem::path& path) {
+    Slot& entry = slot(programs, path);
+    std::lock_guard<std::mutex> lock(entry.mutex);
+    if (entry.loaded) {
+        hit_count++;
+        return entry.program;
+    }
+    miss_count++;
+    entry.stamp = stampOf(path);
+    const std::string& text = source(path);
+    // The parser pulls tokens from the lexer as it goes, so the two are timed together
+    timeTrace::Scope trace("Lex & parse", path.string());
+    Lexer lexer(text, path);
+    parser::Parser parser(&lexer);
+    entry.program = parser.parseProgram();
+    entry.loaded = true;
+    return entry.program;
+}
+
+AST::Program* ASTCache::interface(const std::filesystem::path& path, const std::function<AST::Program*()>& load) {
+    Slot& entry = slot(interfaces, path);
+    std::lock_guard<std::mutex> lock(entry.mutex);
+    if (entry.loaded) {
+        hit_count++;
+        return entry.program;
+    }
+    miss_count++;
+    timeTrace::Scope trace("Load interface", path.string());
+    entry.stamp = stampOf(path);
+    entry.program = load();
+    entry.loaded = entry.program != nullptr;
+    return entry.program;
+}
+
+size_t ASTCache::dropStale() {
+    std::lock_guard<std::mutex> lock(slots_mutex);
+    size_t dropped = 0;
+    for (SlotMap* slots : {&sources, &programs, &interfaces}) {
+        for (auto it = slots->begin(); it != slots->end();) {
+            if (it->second->loaded && it->second->stamp == stampOf(it->first)) {
+                ++it;
+                continue;
             }
-        }
-        if (!found) {
-            auto newFolder = new compilationState::RecordFolder();
-            newFolder->name = part.string();
-            newFolder->parent = currentFolder;
-            currentFolder->files_or_folder.push_back(newFolder);
-            currentFolder = newFolder;
+            delete it->second->program;
+            it = slots->erase(it);
+            dropped++;
         }
     }
+    return dropped;
+}
 
-    for (auto& item : currentFolder->files_or_folder) {
-        if (auto file = std::get_if<compilationState::RecordFile*>(&item)) {
-            if ((*file)->name == relativePath.filename().string()) { return *file; }
+RecordFolder::~RecordFolder() {
+    for (auto& shard : shards) {
+        for (Entry* entry = shard.head.load(std::memory_order_relaxed); entry;) {
+            Entry* next = entry->next;
+            delete entry;
+            entry = next;
         }
     }
+}
 
-    auto newFile = new compilationState::RecordFile();
-    newFile->name = relativePath.filename().string();
-    newFile->parent = currentFolder;
-    currentFolder->files_or_folder.push_back(newFile);
-    return newFile;
+RecordFolder::Entry* RecordFolder::find(Entry* head, size_t hash, const std::string& path) {
+    for (Entry* entry = head; entry; entry = entry->next) {
+        if (entry->hash == hash && entry->path == path) return entry;
+    }
+    return nullptr;
+}
+
+RecordFile* RecordFolder::findOrCreate(const std::filesystem::path& relativePath) {
+    std::string path = relativePath.lexically_normal().generic_string();
+    size_t hash = std::hash<std::string>{}(path);
+    Shard& shard = shards[hash % SHARD_COUNT];
+    if (Entry* entry = find(shard.head.load(std::memory_order_acquire), hash, path)) return &entry->file;
+
+    std::lock_guard<std::mutex> lock(shard.insert_mutex);
+    // Another worker may have created it since the lookup
+    Entry* head = shard.head.load(std::memory_order_acquire);
+    if (Entry* entry = find(head, hash, path)) return &entry->file;
+    auto* entry = new Entry(hash, path, head);
+    entry->file.name = path;
+    entry->file.folder = this;
+    shard.head.store(entry, std::memory_order_release);
+    return &entry->file;
+}
+
+} // namespace compilationState
+
+// =======================================
+// Global File Record Helper
+// =======================================
+compilationState::RecordFile* findOrCreateFileRecord(compilationState::RecordFolder* rootFolder, const std::filesystem::path& relativePath) {
+    return rootFolder->findOrCreate(relativePath);
 }
@@ -1,7 +1,15 @@
 #ifndef COMPILATION_STATE
 #define COMPILATION_STATE
 #include "compiler/enviornment/enviornment.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 #include <filesystem>
@@ -16,8 +24,17 @@ std::string runCommand(const std::string& command, int& exit_code);
 // =======================================
 namespace Utils {
 std::string readFileToString(const std::filesystem::path& filePath);
-size_t computeHash(const std::string& content);
+uint64_t computeHash(const std::string& content);
 void createDirectories(const std::filesystem::path& path);
+
+/**
+ * @brief Runs `run` in a forked child and waits for it.
+ *
+ * Errors end the process that raises them, so a long-lived process
+ * (--serve, --watch) builds in a child and survives a failed build.
+ * @return The child's exit status; 128 + signal if it was killed.
+ */
+int runInChild(const std::function<int()>& run);
 } // namespace Utils
 
 namespace compilationState {
@@ -25,31 +42,184 @@ namespace compilationState {
 class RecordFolder;
 class RecordFile {
   public:
-    std::string name;
+    /**
+     * @enum State
+     * @brief Compilation progress of a file.
+     */
+    enum class State {
+        Pending,    ///< Nobody has started compiling the file yet
+        InProgress, ///< A worker is compiling the file
+        Done,       ///< Compiled; `env` holds its records
+        Failed      ///< Compilation failed; see failureMessage()
+    };
+
+    std::string name;                        ///< Path relative to src/, as a generic string
     enviornment::Enviornment* env = nullptr;
-    bool compiled = false;
-    RecordFolder* parent = nullptr;
+    RecordFolder* folder = nullptr;          ///< The build the file belongs to; its imports are looked up there
 
     ~RecordFile() {
         delete env;
     }
+
+    State getState() const;
+
+    bool isCompiled() const { return getState() == State::Done; }
+
+    /**
+     * @brief Claims the file for compilation.
+     * @return true if the caller moved the file from Pending to InProgress and must compile it.
+     */
+    bool tryStart();
+
+    /**
+     * @brief Marks the interface of the file as written ahead of its compilation, for import cycles.
+     *
+     * Importers stop waiting: the declarations are all they need. The file
+     * itself still has to be started & compiled.
+     */
+    void markDeclared();
+
+    /**
+     * @brief Marks the file as compiled and wakes every importer waiting on it.
+     */
+    void markDone();
+
+    /**
+     * @brief Marks the file as failed and wakes every importer waiting on it.
+     * @param message Reason reported to the importers.
+     */
+    void markFailed(const std::string& message);
+
+    /**
+     * @brief Blocks until the file is Done or Failed, or its declarations were written by markDeclared().
+     * @return The state the file is in.
+     */
+    State wait();
+
+    std::string failureMessage() const;
+
+  private:
+    mutable std::mutex state_mutex;
+    std::condition_variable state_cv;
+    State state = State::Pending;
+    bool declared = false;
+    std::string failure_message;
 };
 
+/**
+ * @class RecordFolder
+ * @brief The records of every file of a build, keyed by path relative to src/.
+ *
+ * Every worker looks records up for each file and each import, so lookups
+ * take no lock: the paths are hashed into shards, each a list that only ever
+ * grows at its head, published with a release store. Creating a record locks
+ * only its shard. Records live as long as the folder.
+ */
 class RecordFolder {
   public:
-    std::string name;
-    std::vector<std::variant<RecordFile*, RecordFolder*>> files_or_folder = {};
-    RecordFolder* parent = nullptr;
-
-        ~RecordFolder() {
-            for (auto& item : files_or_folder) {
-                if (std::holds_alternative<RecordFile*>(item)) {
-                    delete std::get<RecordFile*>(item);
-                } else if (std::holds_alternative<RecordFolder*>(item)) {
-                    delete std::get<RecordFolder*>(item);
-                }
-            }
-        }
+    RecordFolder() = default;
+    RecordFolder(const RecordFolder&) = delete;
+    RecordFolder& operator=(const RecordFolder&) = delete;
+    ~RecordFolder();
+
+    /**
+     * @brief The record of a file, created on first use.
+     * @param relativePath Path relative to src/; `a/../b.gc` and `b.gc` are the same file.
+     */
+    RecordFile* findOrCreate(const std::filesystem::path& relativePath);
+
+  private:
+    struct Entry {
+        Entry(size_t hash, std::string path, Entry* next) : hash(hash), path(std::move(path)), next(next) {}
+        const size_t hash;
+        const std::string path;
+        Entry* const next;
+        RecordFile file;
+    };
+
+    // Padded to a cache line, so inserts into one shard do not slow down lookups in its neighbours
+    struct alignas(64) Shard {
+        std::atomic<Entry*> head = nullptr;
+        std::mutex insert_mutex;
+    };
+
+    static Entry* find(Entry* head, size_t hash, const std::string& path);
+
+    static constexpr size_t SHARD_COUNT = 128;
+    std::array<Shard, SHARD_COUNT> shards;
+};
+
+/**
+ * @class ASTCache
+ * @brief Sources and programs shared by every file compiled in one build.
+ *
+ * Entries are keyed by absolute path and loaded once, by whichever thread asks
+ * first; the others wait for it. A loaded program is never modified, so any
+ * number of compilers may read it at the same time. Everything lives until
+ * dropStale() finds its file changed or the cache is destroyed.
+ */
+class ASTCache {
+  public:
+    ASTCache() = default;
+    ASTCache(const ASTCache&) = delete;
+    ASTCache& operator=(const ASTCache&) = delete;
+    ~ASTCache();
+
+    /**
+     * @brief Contents of a source file, read on first use.
+     */
+    const std::string& source(const std::filesystem::path& path);
+
+    /**
+     * @brief Program of a .gc file, lexed and parsed from source() on first use.
+     */
+    AST::Program* program(const std::filesystem::path& path);
+
+    /**
+     * @brief Program of a module interface, loaded on first use.
+     * @param path The interface file.
+     * @param load Reads the interface; a nullptr result is not cached, so the next call retries.
+     */
+    AST::Program* interface(const std::filesystem::path& path, const std::function<AST::Program*()>& load);
+
+    /**
+     * @brief Drops the entries whose file changed or disappeared since it was loaded.
+     *
+     * For caches that outlive a build, like the one of `gigly --serve`. Must not
+     * run while a build is using the cache.
+     * @return The number of entries dropped.
+     */
+    size_t dropStale();
+
+    size_t hits() const { return hit_count; }
+    size_t misses() const { return miss_count; }
+
+  private:
+    // Modification time & size of a file when it was loaded
+    struct FileStamp {
+        std::filesystem::file_time_type time;
+        uintmax_t size = 0;
+        bool operator==(const FileStamp&) const = default;
+    };
+    static FileStamp stampOf(const std::filesystem::path& path);
+
+    struct Slot {
+        std::mutex mutex;
+        bool loaded = false;
+        FileStamp stamp;
+        std::string source;
+        AST::Program* program = nullptr;
+    };
+    using SlotMap = std::unordered_map<std::string, std::unique_ptr<Slot>>;
+
+    Slot& slot(SlotMap& slots, const std::filesystem::path& path);
+
+    std::mutex slots_mutex; // Protects the maps, not the slots
+    SlotMap sources;
+    SlotMap programs;
+    SlotMap interfaces;
+    std::atomic<size_t> hit_count = 0;
+    std::atomic<size_t> miss_count = 0;
 };
 }
 
@@ -0,0 +1,282 @@
+#include "compile_server.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "compilation_state.hpp"
+
+namespace compileServer {
+
+namespace {
+
+// Limits on a request, so a stray connection cannot make the daemon allocate without bound
+constexpr uint32_t MAX_STRINGS = 4096;
+constexpr uint32_t MAX_STRING_SIZE = 1 << 20;
+// A client sends its whole request at once; one that stalls longer is dropped instead of holding the daemon
+constexpr int REQUEST_TIMEOUT_SECONDS = 5;
+
+/**
+ * @struct WarmRequest
+ * @brief A successful build whose project is yet to be loaded into the warm state.
+ */
+struct WarmRequest {
+    std::filesystem::path workingDirectory;
+    std::vector<std::string> args; ///< Arguments of the build, with the program name
+    std::filesystem::file_time_type started;
+};
+
+bool socketAddress(const std::filesystem::path& path, sockaddr_un& address) {
+    std::string name = path.string();
+    if (name.empty() || name.size() >= sizeof(address.sun_path)) return false;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+    return true;
+}
+
+int connectTo(const std::filesystem::path& path) {
+    sockaddr_un address;
+    if (!socketAddress(path, address)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+bool receiveAll(int fd, void* data, size_t size) {
+    auto bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = recv(fd, bytes, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= received;
+    }
+    return true;
+}
+
+// A request is the number of strings, then every string as its size & bytes
+bool sendStrings(int fd, const std::vector<std::string>& strings) {
+    uint32_t count = strings.size();
+    if (!sendAll(fd, &count, sizeof(count))) return false;
+    for (const auto& string : strings) {
+        uint32_t size = string.size();
+        if (!sendAll(fd, &size, sizeof(size)) || !sendAll(fd, string.data(), size)) return false;
+    }
+    return true;
+}
+
+bool receiveStrings(int fd, std::vector<std::string>& strings) {
+    uint32_t count;
+    if (!receiveAll(fd, &count, sizeof(count)) || count > MAX_STRINGS) return false;
+    strings.resize(count);
+    for (auto& string : strings) {
+        uint32_t size;
+        if (!receiveAll(fd, &size, sizeof(size)) || size > MAX_STRING_SIZE) return false;
+        string.resize(size);
+        if (!receiveAll(fd, string.data(), size)) return false;
+    }
+    return true;
+}
+
+// stdin, stdout & stderr travel as SCM_RIGHTS next to a single marker byte
+bool sendStdio(int fd) {
+    int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    char marker = 'G';
+    iovec iov{&marker, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(header), fds, sizeof(fds));
+    return sendmsg(fd, &message, MSG_NOSIGNAL) == 1;
+}
+
+bool receiveStdio(int fd, int (&fds)[3]) {
+    char marker;
+    iovec iov{&marker, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (recvmsg(fd, &message, MSG_CMSG_CLOEXEC) != 1) return false;
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if (!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS || header->cmsg_len != CMSG_LEN(sizeof(fds))) return false;
+    std::memcpy(fds, CMSG_DATA(header), sizeof(fds));
+    return true;
+}
+
+// Whether a client is already waiting to be accepted
+bool clientWaiting(int listener) {
+    pollfd waiting{listener, POLLIN, 0};
+    return poll(&waiting, 1, 0) > 0;
+}
+
+void warm(const WarmRequest& request, const Hooks& hooks) {
+    std::vector<std::string> args = request.args;
+    std::vector<char*> argv;
+    for (auto& arg : args) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    hooks.warm(request.workingDirectory, static_cast<int>(args.size()), argv.data(), request.started);
+}
+
+/**
+ * @brief Serves one request.
+ * @return The project to warm if the build succeeded.
+ */
+std::optional<WarmRequest> handle(int client, const Hooks& hooks) {
+    timeval timeout{REQUEST_TIMEOUT_SECONDS, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int stdio[3];
+    if (!receiveStdio(client, stdio)) return std::nullopt;
+    // The client's working directory, then its arguments
+    std::vector<std::string> request;
+    bool valid = receiveStrings(client, request) && !request.empty();
+    if (!valid) {
+        for (int fd : stdio) close(fd);
+        return std::nullopt;
+    }
+
+    // A watch would hold the daemon forever and run & repl need the client's terminal; clients run them themselves
+    std::string refused;
+    if (std::find(request.begin() + 1, request.end(), "--watch") != request.end()) refused = "--watch";
+    else if (request.size() > 1 && (request[1] == "run" || request[1] == "repl")) refused = request[1];
+    if (!refused.empty()) {
+        dprintf(stdio[2], "Error: the compile server does not serve gigly %s; run it without --server\n", refused.c_str());
+        for (int fd : stdio) close(fd);
+        int32_t status = 1;
+        sendAll(client, &status, sizeof(status));
+        return std::nullopt;
+    }
+
+    std::filesystem::path workingDirectory = request[0];
+    std::vector<std::string> args = {"gigly"};
+    args.insert(args.end(), request.begin() + 1, request.end());
+    std::vector<char*> argv;
+    for (auto& arg : args) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    int argc = static_cast<int>(args.size());
+
+    hooks.refresh();
+    auto started = std::filesystem::file_time_type::clock::now();
+
+    int32_t status = Utils::runInChild([&]() {
+        std::signal(SIGPIPE, SIG_DFL);
+        for (int target = 0; target < 3; ++target) dup2(stdio[target], target);
+        for (int fd : stdio) {
+            if (fd > STDERR_FILENO) close(fd);
+        }
+        if (chdir(workingDirectory.c_str()) != 0) {
+            std::cerr << "Error: compile server could not enter " << workingDirectory.string() << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        return hooks.build(argc, argv.data());
+    });
+    for (int fd : stdio) close(fd);
+    sendAll(client, &status, sizeof(status));
+
+    if (status != 0) return std::nullopt;
+    return WarmRequest{workingDirectory, std::move(args), started};
+}
+
+} // namespace
+
+int serve(const std::filesystem::path& socketPath, const Hooks& hooks) {
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address)) {
+        std::cerr << "Error: invalid socket path " << socketPath.string() << std::endl;
+        return 1;
+    }
+    // A socket nobody answers on is left over from a daemon that was killed
+    int running = connectTo(socketPath);
+    if (running >= 0) {
+        close(running);
+        std::cerr << "Error: a compile server is already listening on " << socketPath.string() << std::endl;
+        return 1;
+    }
+    std::error_code ec;
+    std::filesystem::remove(socketPath, ec);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        std::cerr << "Error: could not listen on " << socketPath.string() << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    // A client that goes away must not take the daemon with it
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cout << "Compile server listening on " << socketPath.string() << std::endl;
+
+    // Warming runs only while no client waits, so it never delays the next build
+    std::vector<WarmRequest> pendingWarms;
+    while (true) {
+        while (!pendingWarms.empty() && !clientWaiting(listener)) {
+            warm(pendingWarms.front(), hooks);
+            pendingWarms.erase(pendingWarms.begin());
+        }
+        int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            std::cerr << "Error: compile server stopped accepting: " << std::strerror(errno) << std::endl;
+            close(listener);
+            return 1;
+        }
+        auto warmRequest = handle(client, hooks);
+        close(client);
+        if (!warmRequest) continue;
+        // A newer build of the same project supersedes the one still waiting to be warmed
+        std::erase_if(pendingWarms, [&](const WarmRequest& pending) {
+            return pending.workingDirectory == warmRequest->workingDirectory && pending.args == warmRequest->args;
+        });
+        pendingWarms.push_back(std::move(*warmRequest));
+    }
+}
+
+std::optional<int> forward(const std::filesystem::path& socketPath, const std::vector<std::string>& args) {
+    int server = connectTo(socketPath);
+    if (server < 0) return std::nullopt;
+
+    std::vector<std::string> request = {std::filesystem::current_path().string()};
+    request.insert(request.end(), args.begin(), args.end());
+    int32_t status = 1;
+    if (!sendStdio(server) || !sendStrings(server, request) || !receiveAll(server, &status, sizeof(status))) {
+        std::cerr << "Error: the compile server on " << socketPath.string() << " did not answer" << std::endl;
+        status = 1;
+    }
+    close(server);
+    return status;
+}
+
+} // namespace compileServer
@@ -0,0 +1,54 @@
+#ifndef COMPILE_SERVER_HPP
+#define COMPILE_SERVER_HPP
+
+/**
+ * @file compile_server.hpp
+ * @brief The `gigly --serve` daemon and its thin client.
+ *
+ * The daemon listens on a Unix domain socket. A client sends its working
+ * directory, its arguments and its stdin/stdout/stderr; the daemon forks and
+ * runs the build in the child, which writes straight to the client's
+ * terminal. Errors end the process that raised them, so a failed build only
+ * ends its child. The child inherits the daemon's warm state (initialized
+ * targets, cached TargetMachines, parsed programs and interfaces) copy-on-write.
+ *
+ * Requests are served one at a time; every build is parallel by itself. A
+ * client that does not send its request within a few seconds is dropped, and
+ * loading a built project into the warm state waits until no client does.
+ */
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace compileServer {
+
+/**
+ * @struct Hooks
+ * @brief What the daemon does around each request.
+ */
+struct Hooks {
+    std::function<void()> refresh;              ///< In the daemon, before forking: drop stale warm state
+    std::function<int(int, char*[])> build;     ///< In the child: run the build, return its exit status
+    /// In the daemon, after a successful build once no client waits: its working directory, arguments and start time
+    std::function<void(const std::filesystem::path&, int, char*[], std::filesystem::file_time_type)> warm;
+};
+
+/**
+ * @brief Serves compile requests on a socket until the daemon is killed.
+ * @return Exit status; only returns if the socket could not be set up.
+ */
+int serve(const std::filesystem::path& socketPath, const Hooks& hooks);
+
+/**
+ * @brief Runs a build on the daemon listening on a socket.
+ * @param args Arguments of the build, without the program name.
+ * @return The exit status of the build, or nothing if no daemon is listening.
+ */
+std::optional<int> forward(const std::filesystem::path& socketPath, const std::vector<std::string>& args);
+
+} // namespace compileServer
+
+#endif // COMPILE_SERVER_HPP
@@ -2,9 +2,14 @@
 #include "../parser/parser.hpp"
 #include "compiler.hpp"
 #include <llvm/IR/DerivedTypes.h>
+#include <mutex>
 
 void compiler::Compiler::initilizeArray() {
-    Lexer lexer_instance(
+    // Parsed once per process and shared by every Compiler, like the programs of the AST cache
+    static AST::Program* ast_instance = nullptr;
+    static std::once_flag parsed;
+    std::call_once(parsed, []() {
+        Lexer lexer_instance(
 R"(
 @generic(T: Any)
 struct array {
@@ -19,10 +24,10 @@ struct array {
     }
 };
 )",
-this->file_path);
-    auto parser_instance = parser::Parser(&lexer_instance);
-    auto ast_instance = parser_instance.parseProgram();
+"<builtin array>");
+        auto parser_instance = parser::Parser(&lexer_instance);
+        ast_instance = parser_instance.parseProgram();
+    });
     this->compile(ast_instance->statements[0]);
     this->ll_array = llvm::StructType::create(this->llvm_context, {this->ll_pointer, this->ll_int}, "array");
-    this->auto_free_programs.push_back(ast_instance);
 };
\ No newline at end of file
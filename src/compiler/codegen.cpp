@@ -0,0 +1,159 @@
+#include "codegen.hpp"
+
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/TargetParser/Host.h>
+#include <optional>
+
+#include "../errors/errors.hpp"
+#include "../time_trace.hpp"
+#include "optimizer.hpp"
+
+namespace compiler {
+
+TargetRegistry::Lease& TargetRegistry::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        registry = other.registry;
+        key = std::move(other.key);
+        machine = std::move(other.machine);
+    }
+    return *this;
+}
+
+void TargetRegistry::Lease::release() {
+    if (!machine) return;
+    std::lock_guard<std::mutex> lock(registry->mutex);
+    registry->slots[key].idle.push_back(std::move(machine));
+}
+
+TargetRegistry& TargetRegistry::instance() {
+    static TargetRegistry registry;
+    return registry;
+}
+
+void TargetRegistry::initializeTargets() {
+    // ALL targets, so cross-compilation triples can be looked up too
+    static std::once_flag initialized;
+    std::call_once(initialized, []() {
+        llvm::InitializeAllTargetInfos();
+        llvm::InitializeAllTargets();
+        llvm::InitializeAllTargetMCs();
+        llvm::InitializeAllAsmPrinters();
+    });
+}
+
+TargetRegistry::Lease TargetRegistry::acquire(const TargetKey& key) {
+    std::string triple = key.triple.empty() ? llvm::sys::getDefaultTargetTriple() : key.triple;
+    std::string id = triple + "|" + key.cpu + "|" + key.features + "|" + std::to_string(static_cast<int>(key.reloc_model));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot& slot = slots[id];
+        if (!slot.known) return Lease();
+        if (!slot.idle.empty()) {
+            auto machine = std::move(slot.idle.back());
+            slot.idle.pop_back();
+            return Lease(this, id, std::move(machine));
+        }
+    }
+
+    auto machine = create(key, triple);
+    if (!machine) {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[id].known = false;
+        return Lease();
+    }
+    return Lease(this, id, std::move(machine));
+}
+
+std::optional<llvm::DataLayout> TargetRegistry::dataLayout(const TargetKey& key) {
+    Lease lease = acquire(key);
+    if (!lease) return std::nullopt;
+    return lease->createDataLayout();
+}
+
+std::unique_ptr<llvm::TargetMachine> TargetRegistry::create(const TargetKey& key, const std::string& triple) {
+    initializeTargets();
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        llvm::errs() << "Warning: could not find target for triple '" << triple << "': " << error << "\n";
+        return nullptr;
+    }
+    llvm::TargetOptions opt;
+    // One section per function/global so `gigly --gc-sections` can drop unused code
+    opt.FunctionSections = true;
+    opt.DataSections = true;
+    std::optional<llvm::Reloc::Model> reloc_model = key.reloc_model;
+    created_count++;
+    return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(triple, key.cpu, key.features, opt, reloc_model));
+}
+
+TargetRegistry::Lease acquireTargetMachine(const std::string& triple) {
+    return TargetRegistry::instance().acquire(TargetKey{triple});
+}
+
+void verifyModule(const llvm::Module& module, const std::string& what) {
+    // Same check clang performs when it parses IR, without the round trip through text
+    std::string verify_errors;
+    llvm::raw_string_ostream verify_stream(verify_errors);
+    if (llvm::verifyModule(module, &verify_stream)) { errors::raiseCompilationError("Generated invalid LLVM IR for " + what + "\n" + verify_stream.str()); }
+}
+
+// Runs the code generation passes of `target_machine` over the module into `dest`
+static void lowerToObject(llvm::Module& module, llvm::TargetMachine* target_machine, llvm::raw_pwrite_stream& dest, const std::string& optimization_level) {
+    if (!target_machine) { errors::raiseCompilationError("No target machine available for triple '" + module.getTargetTriple() + "'"); }
+    target_machine->setOptLevel(codeGenOptLevel(optimization_level));
+
+    llvm::legacy::PassManager pass_manager;
+    if (target_machine->addPassesToEmitFile(pass_manager, dest, nullptr, llvm::CodeGenFileType::ObjectFile)) {
+        errors::raiseCompilationError("Target '" + module.getTargetTriple() + "' cannot emit object files");
+    }
+    pass_manager.run(module);
+}
+
+void emitObjectFile(llvm::Module& module, llvm::TargetMachine* target_machine, const std::filesystem::path& obj_path, const std::string& optimization_level) {
+    timeTrace::Scope trace("Emit object", obj_path.string());
+    std::error_code EC;
+    llvm::raw_fd_ostream dest(obj_path.string(), EC, llvm::sys::fs::OF_None);
+    if (EC) { errors::raiseCompilationError("Could not open object file " + obj_path.string() + ": " + EC.message()); }
+
+    lowerToObject(module, target_machine, dest, optimization_level);
+    dest.flush();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> emitObjectBuffer(llvm::Module& module, llvm::TargetMachine* target_machine, const std::string& optimization_level) {
+    timeTrace::Scope trace("Emit object", module.getModuleIdentifier());
+    llvm::SmallVector<char, 0> object;
+    llvm::raw_svector_ostream dest(object);
+    lowerToObject(module, target_machine, dest, optimization_level);
+    return llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(object.data(), object.size()), module.getModuleIdentifier());
+}
+
+void emitBitcodeFile(llvm::Module& module, const std::filesystem::path& bc_path, bool with_summary) {
+    timeTrace::Scope trace("Emit bitcode", bc_path.string());
+    std::error_code EC;
+    llvm::raw_fd_ostream dest(bc_path.string(), EC, llvm::sys::fs::OF_None);
+    if (EC) { errors::raiseCompilationError("Could not open bitcode file " + bc_path.string() + ": " + EC.message()); }
+
+    if (with_summary) {
+        // The summary tells the ThinLTO backend what it may import from this module
+        llvm::ProfileSummaryInfo profile_summary(module);
+        auto index = llvm::buildModuleSummaryIndex(module, nullptr, &profile_summary);
+        llvm::WriteBitcodeToFile(module, dest, false, &index);
+    } else {
+        llvm::WriteBitcodeToFile(module, dest);
+    }
+    dest.flush();
+}
+
+} // namespace compiler
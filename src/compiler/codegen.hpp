@@ -0,0 +1,160 @@
+#ifndef CODEGEN_HPP
+#define CODEGEN_HPP
+
+/**
+ * @file codegen.hpp
+ * @brief Lowering of finished LLVM modules: target machines, verification, objects and bitcode.
+ *
+ * These work on any module, so besides Compiler they are used for modules
+ * that no single Compiler owns, like the merged module of `gigly --unity`.
+ */
+
+#include <atomic>
+#include <filesystem>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace compiler {
+
+/**
+ * @struct TargetKey
+ * @brief Everything a TargetMachine is created from.
+ */
+struct TargetKey {
+    std::string triple;            ///< Empty = host native
+    std::string cpu = "generic";
+    std::string features;
+    llvm::Reloc::Model reloc_model = llvm::Reloc::PIC_;
+};
+
+/**
+ * @class TargetRegistry
+ * @brief Process-wide cache of TargetMachines.
+ *
+ * LLVM's targets are initialized once, on first use. Creating a TargetMachine
+ * is expensive, so machines are created once per TargetKey and reused. A
+ * machine is not safe to use from two threads at once (lowering changes its
+ * opt level), so it is leased: the worker holding a Lease has it to itself,
+ * and the machine goes back to the cache when the lease ends. Concurrent
+ * workers on the same target each get their own machine.
+ */
+class TargetRegistry {
+  public:
+    /**
+     * @brief Exclusive use of a cached TargetMachine; empty if the target is unknown.
+     */
+    class Lease {
+      public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept : registry(other.registry), key(std::move(other.key)), machine(std::move(other.machine)) {}
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        llvm::TargetMachine* get() const { return machine.get(); }
+        llvm::TargetMachine* operator->() const { return machine.get(); }
+        explicit operator bool() const { return machine != nullptr; }
+
+      private:
+        friend class TargetRegistry;
+        Lease(TargetRegistry* registry, std::string key, std::unique_ptr<llvm::TargetMachine> machine) : registry(registry), key(std::move(key)), machine(std::move(machine)) {}
+        void release();
+
+        TargetRegistry* registry = nullptr;
+        std::string key;
+        std::unique_ptr<llvm::TargetMachine> machine;
+    };
+
+    TargetRegistry(const TargetRegistry&) = delete;
+    TargetRegistry& operator=(const TargetRegistry&) = delete;
+
+    static TargetRegistry& instance();
+
+    /**
+     * @brief Registers every LLVM target; only the first call does any work.
+     */
+    static void initializeTargets();
+
+    /**
+     * @brief Leases a machine for a target, creating one if none is idle.
+     *
+     * An unknown triple is warned about once and yields an empty lease.
+     */
+    Lease acquire(const TargetKey& key);
+
+    /**
+     * @brief Data layout of a target, without keeping a machine leased.
+     * @return The layout, or nothing if the target is unknown.
+     */
+    std::optional<llvm::DataLayout> dataLayout(const TargetKey& key);
+
+    size_t created() const { return created_count; } ///< Machines created so far
+
+  private:
+    TargetRegistry() = default;
+
+    struct Slot {
+        bool known = true; ///< False once lookup failed, so the warning is given once
+        std::vector<std::unique_ptr<llvm::TargetMachine>> idle;
+    };
+
+    std::unique_ptr<llvm::TargetMachine> create(const TargetKey& key, const std::string& triple);
+
+    std::mutex mutex; // Protects slots; machines are created outside of it
+    std::unordered_map<std::string, Slot> slots;
+    std::atomic<size_t> created_count = 0;
+};
+
+/**
+ * @brief Leases the TargetMachine gigly generates code with for a triple.
+ * @param triple Target triple; empty means the host.
+ * @return The lease, empty (after a warning) if the triple is unknown.
+ */
+TargetRegistry::Lease acquireTargetMachine(const std::string& triple);
+
+/**
+ * @brief Verifies a module, raising a compilation error if it is invalid.
+ * @param module The module to check.
+ * @param what Name of the module in the error message.
+ */
+void verifyModule(const llvm::Module& module, const std::string& what);
+
+/**
+ * @brief Lowers a module to a native object file.
+ * @param module The module; code generation passes may modify it.
+ * @param target_machine Target to lower for.
+ * @param obj_path Path of the object file to write.
+ * @param optimization_level Code generation level ("", "0"-"3", "s", "z", "fast").
+ */
+void emitObjectFile(llvm::Module& module, llvm::TargetMachine* target_machine, const std::filesystem::path& obj_path, const std::string& optimization_level = "");
+
+/**
+ * @brief Lowers a module to a native object in memory, e.g. for a JIT to load.
+ * @param module The module; code generation passes may modify it.
+ * @param target_machine Target to lower for.
+ * @param optimization_level Code generation level ("", "0"-"3", "s", "z", "fast").
+ * @return The object, named after the module.
+ */
+std::unique_ptr<llvm::MemoryBuffer> emitObjectBuffer(llvm::Module& module, llvm::TargetMachine* target_machine, const std::string& optimization_level = "");
+
+/**
+ * @brief Writes a module as LLVM bitcode.
+ * @param module The module.
+ * @param bc_path Path of the bitcode file to write.
+ * @param with_summary Embed the module summary ThinLTO needs.
+ */
+void emitBitcodeFile(llvm::Module& module, const std::filesystem::path& bc_path, bool with_summary = false);
+
+} // namespace compiler
+
+#endif // CODEGEN_HPP
@@ -2,32 +2,47 @@
 #include "compiler.hpp"
 #include <cmath>
 #include <iostream>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GlobalValue.h>
 #include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
+#include <llvm/IR/Verifier.h>
 #include <llvm/MC/TargetRegistry.h>
-#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/TargetParser/Host.h>
 #include <optional>
-#include <thread>
 #include <unordered_map>
 
 #include "../errors/errors.hpp"
 #include "../lexer/lexer.hpp"
 #include "../parser/parser.hpp"
+#include "../time_trace.hpp"
+#include "codegen.hpp"
 #include "enviornment/enviornment.hpp"
+#include "interface.hpp"
+#include "optimizer.hpp"
 
 using namespace compiler;
 using llConstInt = llvm::ConstantInt;
 
 Compiler::Compiler(
-    const Str& source, const std::filesystem::path& file_path, compilationState::RecordFile* file_record, const std::filesystem::path& buildDir, const std::filesystem::path& relativePath, const Str& target_triple)
-    : llvm_context(), llvm_ir_builder(llvm_context), source(source), file_path(std::move(file_path)), file_record(file_record), buildDir(std::move(buildDir)), relativePath(std::move(relativePath)) {
+    const Str& source, const std::filesystem::path& file_path, compilationState::RecordFile* file_record, const std::filesystem::path& buildDir, const std::filesystem::path& relativePath, const Str& target_triple, llvm::LLVMContext* shared_context)
+    : owned_llvm_context(shared_context ? nullptr : std::make_unique<llvm::LLVMContext>()), llvm_context(shared_context ? *shared_context : *owned_llvm_context), llvm_ir_builder(llvm_context), source(source), file_path(std::move(file_path)), file_record(file_record), buildDir(std::move(buildDir)), relativePath(std::move(relativePath)) {
+
+    // Imports are relative to the importing file, which is relativePath under src/
+    this->srcDir = this->file_path.lexically_normal();
+    for (auto component = this->relativePath.begin(); component != this->relativePath.end(); ++component) this->srcDir = this->srcDir.parent_path();
+    this->importDir = this->relativePath.parent_path();
 
     // Convert file path to Str
     Str path_str = file_path.string();
@@ -75,34 +90,91 @@ void Compiler::_initializeLLVMModule(const Str& path_str, const Str& target_trip
     this->llvm_module = std::make_unique<llvm::Module>(this->fc_st_name_prefix, this->llvm_context);
     this->llvm_module->setSourceFileName(path_str);
 
-    // Initialize ALL targets so cross-compilation triples can be looked up,
-    // then also initialize the native target for host builds.
-    llvm::InitializeAllTargetInfos();
-    llvm::InitializeAllTargets();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllAsmPrinters();
-
     // Resolve the triple: use the override if provided, otherwise fall back to native.
     std::string triple = target_triple_override.empty()
                              ? llvm::sys::getDefaultTargetTriple()
                              : target_triple_override;
     this->llvm_module->setTargetTriple(triple);
 
-    std::string error;
-    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
-    if (target) {
-        llvm::TargetOptions opt;
-        std::optional<llvm::Reloc::Model> reloc_model = llvm::Reloc::PIC_;
-        std::unique_ptr<llvm::TargetMachine> target_machine(
-            target->createTargetMachine(triple, "generic", "", opt, reloc_model)
-        );
-        if (target_machine) {
-            this->llvm_module->setDataLayout(target_machine->createDataLayout());
+    // The machine is leased again when the module is optimized & lowered
+    if (auto layout = TargetRegistry::instance().dataLayout(TargetKey{triple})) {
+        this->llvm_module->setDataLayout(*layout);
+    }
+}
+
+void Compiler::_verifyModule() {
+    compiler::verifyModule(*this->llvm_module, this->file_path.string());
+}
+
+void Compiler::optimize(const Str& optimization_level, const Str& pass_pipeline, LTOMode lto) {
+    if (optimization_level.empty() && pass_pipeline.empty()) return;
+    // Passes assume well formed IR, so catch codegen bugs before running them
+    this->_verifyModule();
+    auto target_machine = acquireTargetMachine(this->llvm_module->getTargetTriple());
+    optimizeModule(*this->llvm_module, target_machine.get(), optimization_level, pass_pipeline, lto);
+}
+
+void Compiler::emitObjectFile(const std::filesystem::path& obj_path, const Str& optimization_level) {
+    this->_verifyModule();
+    auto target_machine = acquireTargetMachine(this->llvm_module->getTargetTriple());
+    compiler::emitObjectFile(*this->llvm_module, target_machine.get(), obj_path, optimization_level);
+}
+
+void Compiler::emitBitcodeFile(const std::filesystem::path& bc_path, bool with_summary) {
+    this->_verifyModule();
+    compiler::emitBitcodeFile(*this->llvm_module, bc_path, with_summary);
+}
+
+std::unique_ptr<llvm::Module> Compiler::takeIncrementalModule(llvm::LLVMContext& context) {
+    this->_verifyModule();
+    for (auto& global : this->llvm_module->global_values()) {
+        if (!global.hasLocalLinkage()) continue;
+        if (!global.hasName()) global.setName("__incremental_anon");
+        global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        global.setVisibility(llvm::GlobalValue::DefaultVisibility);
+    }
+
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream stream(bitcode);
+    llvm::WriteBitcodeToFile(*this->llvm_module, stream);
+
+    // Constructors & used lists went out with the definitions
+    for (auto& global : llvm::make_early_inc_range(this->llvm_module->globals())) {
+        if (global.hasAppendingLinkage()) {
+            global.eraseFromParent();
+        } else if (!global.isDeclaration()) {
+            global.setInitializer(nullptr);
+            global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            global.setComdat(nullptr);
         }
-    } else {
-        llvm::errs() << "Warning: could not find target for triple '" << triple
-                     << "': " << error << "\n";
+        global.setDSOLocal(false); // The definition may be anywhere in the JIT's memory
+    }
+    for (auto& function : *this->llvm_module) {
+        if (!function.isDeclaration()) {
+            function.deleteBody();
+            function.setComdat(nullptr);
+        }
+        function.setDSOLocal(false);
     }
+
+    auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), this->llvm_module->getModuleIdentifier()), context);
+    if (!module) { errors::raiseCompilationError("Could not move the compiled module: " + llvm::toString(module.takeError())); }
+    return std::move(*module);
+}
+
+std::unique_ptr<llvm::Module> Compiler::cloneForTarget(llvm::LLVMContext& context, const Str& target_triple) {
+    this->_verifyModule();
+    // Contexts cannot share IR, so the copy goes through bitcode
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream stream(bitcode);
+    llvm::WriteBitcodeToFile(*this->llvm_module, stream);
+
+    auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), this->llvm_module->getModuleIdentifier()), context);
+    if (!module) { errors::raiseCompilationError("Could not copy the compiled module for " + target_triple + ": " + llvm::toString(module.takeError())); }
+    (*module)->setTargetTriple(target_triple);
+    // An unknown target keeps the layout; lowering reports it
+    if (auto layout = TargetRegistry::instance().dataLayout(TargetKey{target_triple})) { (*module)->setDataLayout(*layout); }
+    return std::move(*module);
 }
 
 void Compiler::_initializeEnvironment() {
@@ -330,9 +402,12 @@ void Compiler::_visitContinueStatement(AST::ContinueStatement* node) {
 void Compiler::_visitProgram(AST::Program* program) {
     for (const auto& stmt : program->statements) {
         switch (stmt->type()) {
-            case (AST::NodeType::FunctionStatement):
-                this->_visitFunctionDeclarationStatement(stmt->castToFunctionStatement());
+            case (AST::NodeType::FunctionStatement): {
+                auto function_statement = stmt->castToFunctionStatement();
+                timeTrace::Scope trace(timeTrace::CODEGEN_FUNCTION, this->relativePath.string() + ": " + function_statement->name->castToIdentifierLiteral()->value);
+                this->_visitFunctionDeclarationStatement(function_statement);
                 break;
+            }
             case AST::NodeType::VariableDeclarationStatement:
                 this->_visitVariableDeclarationStatement(stmt->castToVariableDeclarationStatement(), true);
                 break;
@@ -359,7 +434,18 @@ void Compiler::_visitProgram(AST::Program* program) {
 }
 
 void Compiler::_visitExpressionStatement(AST::ExpressionStatement* expression_statement) {
-    this->compile(expression_statement->expr);
+    if (!this->sink_expression_values) {
+        this->compile(expression_statement->expr);
+        return;
+    }
+    auto [value, value_alloca, _value_type, vtt] = this->_resolveValue(expression_statement->expr);
+    llvm::Value* sunk = value ? value : value_alloca;
+    if ((vtt != resolveType::StructInst && vtt != resolveType::ConstStructInst) || !sunk) return;
+    // The optimizer keeps a volatile store, and with it the work computing the value
+    llvm::Function* current_func = this->llvm_ir_builder.GetInsertBlock()->getParent();
+    llvm::IRBuilder<> temp_builder(&current_func->getEntryBlock(), current_func->getEntryBlock().begin());
+    llvm::Value* sink = temp_builder.CreateAlloca(sunk->getType());
+    this->llvm_ir_builder.CreateStore(sunk, sink, true);
 }
 
 void Compiler::_visitBlockStatement(AST::BlockStatement* block_statement) {
@@ -422,6 +508,7 @@ Compiler::_CallGfunc(const vector<RecordGenericFunction*>& gfuncs, AST::CallExpr
     }
 
     // No exact match found; prepare to handle generic functions
+    timeTrace::Scope trace("Instantiate generic", this->relativePath.string() + ": " + name);
     auto prev_env = this->env;                 // Save current environment
     vector<vector<unsigned short>> mismatches; // Track parameter mismatches
 
@@ -645,9 +732,14 @@ void Compiler::_createFunctionRecord(AST::FunctionStatement* function_declaratio
     // Create the LLVM function type
     auto func_type = llvm::FunctionType::get(llvm_return_type, param_types, false);
 
-    // Prefix the function name if necessary
+    // Prefix the function name if necessary; declarations loaded from a module
+    // interface carry the name they were emitted under
     Str func_name;
-    if (module) func_name = local_file_record->env->getFunction(name, args)->ll_name;
+    auto exported_name = function_declaration_statement->extra_info.str_map.find("ll_name");
+    bool is_imported = module || (struct_ && local_file_record);
+    if (is_imported && exported_name != function_declaration_statement->extra_info.str_map.end()) func_name = exported_name->second;
+    else if (is_imported && !local_file_record->env) errors::raiseCompilationError("Missing declarations of imported file " + local_file_record->name, "Delete the build directory and rebuild.");
+    else if (module) func_name = local_file_record->env->getFunction(name, args)->ll_name;
     else if (struct_ && local_file_record) func_name = local_file_record->env->getStruct(struct_->name)->get_method(name, args)->function->getName().str();
     else func_name = this->fc_st_name_prefix != "main.gc.." ? this->fc_st_name_prefix + name : name;
 
@@ -661,6 +753,8 @@ void Compiler::_createFunctionRecord(AST::FunctionStatement* function_declaratio
     // environment
     auto func_record = new RecordFunction(name, func, func_type, arguments, return_type, function_declaration_statement->extra_info, function_declaration_statement->return_const);
     func_record->ll_name = func->getName().str();
+    // Recorded for the module interface; the AST itself is shared and left untouched
+    if (!is_imported) this->exported_names[function_declaration_statement] = func_record->ll_name;
 
     // Add the function record to the appropriate scope (struct, module, or global
     // environment)
@@ -677,7 +771,7 @@ void Compiler::_createFunctionRecord(AST::FunctionStatement* function_declaratio
     }
 
     // If the function has a body, proceed to compile it
-    if (auto body = function_declaration_statement->body) {
+    if (auto body = function_declaration_statement->body; body && !this->declarations_only) {
         // Create the entry basic block for the function
         auto bb = llvm::BasicBlock::Create(this->llvm_context, "entry", func);
         this->function_entry_block.push_back(bb);
@@ -1136,6 +1230,7 @@ Compiler::_handleStructIndexing(llvm::Value* left_alloca, llvm::Value* index, Re
 
 Compiler::ResolvedValue
 Compiler::_CallGstruct(const vector<RecordGenericStructType*>& gstructs, AST::CallExpression* func_call, const Str& name, vector<llvm::Value*>& args, const vector<RecordStructType*>& params_types) {
+    timeTrace::Scope trace("Instantiate generic", this->relativePath.string() + ": " + name);
     auto prev_env = this->env; // Save the current environment
 
     for (const auto& gstruct : gstructs) {
@@ -3468,6 +3563,7 @@ void Compiler::_cleanupCatchBlocks(int target_catch_count) {
 }
 
 void Compiler::_visitImportStatement(AST::ImportStatement* import_statement, RecordModule* module) {
+    timeTrace::Scope trace("Resolve import", this->relativePath.string() + ": " + import_statement->relativePath);
     // Extract the relative path from the import statement
     Str relative_path = import_statement->relativePath;
 
@@ -3479,8 +3575,14 @@ void Compiler::_visitImportStatement(AST::ImportStatement* import_statement, Rec
         std::replace(module_name.begin(), module_name.end(), '.', '_');
     } else module_name = import_statement->as;
 
+    // The declare pass of an import cycle runs before the other files of the cycle have interfaces
+    auto import_relative = (this->importDir / (relative_path + ".gc")).lexically_normal();
+    if (this->deferred_imports.contains(import_relative.generic_string())) return;
+    // On a cycle the interface of an import leads back to a file already being imported
+    if (import_relative == this->relativePath.lexically_normal() || !this->importing.insert(import_relative.generic_string()).second) return;
+
     // Determine the path for the imported source file
-    std::filesystem::path gc_source_path = this->file_path.parent_path() / (relative_path + ".gc");
+    std::filesystem::path gc_source_path = this->srcDir / import_relative;
     if (!std::filesystem::exists(gc_source_path)) {
         errors::raiseCompletionError(this->file_path,
                                      this->source,
@@ -3492,29 +3594,45 @@ void Compiler::_visitImportStatement(AST::ImportStatement* import_statement, Rec
     }
 
     // Check if the file is already being compiled
-    compilationState::RecordFile* local_file_record = findOrCreateFileRecord(this->file_record->parent, relative_path + ".gc");
+    compilationState::RecordFile* local_file_record = findOrCreateFileRecord(this->file_record->folder, import_relative);
 
-    // Wait until the file is compiled, or compile synchronously if callback is provided
-    if (!local_file_record->compiled) {
-        if (this->compile_dependency_cb) {
-            this->compile_dependency_cb(gc_source_path);
-        } else {
-            while (!local_file_record->compiled) { std::this_thread::sleep_for(std::chrono::milliseconds(100)); }
-        }
+    // Compile synchronously if a callback is provided, otherwise wait for the worker compiling it
+    if (this->compile_dependency_cb && local_file_record->getState() == compilationState::RecordFile::State::Pending) { this->compile_dependency_cb(gc_source_path); }
+    if (local_file_record->wait() == compilationState::RecordFile::State::Failed) {
+        errors::raiseCompletionError(this->file_path,
+                                     this->source,
+                                     import_statement->meta_data.st_line_no,
+                                     import_statement->meta_data.st_col_no,
+                                     import_statement->meta_data.end_line_no,
+                                     import_statement->meta_data.end_col_no,
+                                     "Imported file failed to compile: " + gc_source_path.string() + "\n" + local_file_record->failureMessage());
     }
 
-    // Read the source code from the file
-    Str gc_source = Utils::readFileToString(gc_source_path.string());
+    // Read the source code from the file; it is only kept for diagnostics
+    // unless the interface is missing
+    Str gc_source = this->ast_cache ? this->ast_cache->source(gc_source_path) : Utils::readFileToString(gc_source_path.string());
     Str previous_source = this->source;
     this->source = gc_source;
 
-    // Parse the source code into an AST
-    auto lexer = new Lexer(gc_source, gc_source_path);
-    auto parser = new parser::Parser(lexer);
-    auto program = parser->parseProgram();
-    this->auto_free_programs.push_back(program);
-    delete lexer;
-    delete parser;
+    // Load the declarations from the module interface written when the file
+    // was compiled, and only parse the source if there is none
+    auto interface_path = interfacePath(this->buildDir, import_relative);
+    AST::Program* program = nullptr;
+    if (this->ast_cache) {
+        // Shared with every other importer of the file; owned by the cache
+        program = this->ast_cache->interface(interface_path, [&interface_path]() { return readInterface(interface_path); });
+        if (!program) program = this->ast_cache->program(gc_source_path);
+    } else {
+        program = readInterface(interface_path);
+        if (!program) {
+            auto lexer = new Lexer(gc_source, gc_source_path);
+            auto parser = new parser::Parser(lexer);
+            program = parser->parseProgram();
+            delete lexer;
+            delete parser;
+        }
+        this->auto_free_programs.push_back(program);
+    }
 
     // Create a new module record if not importing into an existing module
     RecordModule* import_module = module;
@@ -3523,8 +3641,11 @@ void Compiler::_visitImportStatement(AST::ImportStatement* import_statement, Rec
         this->env->addRecord(import_module);
     }
 
-    // Save the current environment and create a new one for the imported module
+    // Save the current environment and create a new one for the imported module;
+    // the imports of the imported file are relative to its own directory
     auto prev_env = this->env;
+    auto prev_import_dir = this->importDir;
+    this->importDir = import_relative.parent_path();
     this->env = new Enviornment(prev_env, StrRecordMap{}, module_name);
     prev_env->childes.push_back(this->env);
 
@@ -3547,9 +3668,10 @@ void Compiler::_visitImportStatement(AST::ImportStatement* import_statement, Rec
     }
 
     // Restore the previous state
-    this->file_path = this->file_path.parent_path(); // Adjust path as necessary
     this->env = prev_env;
+    this->importDir = prev_import_dir;
     this->source = previous_source;
+    this->importing.erase(import_relative.generic_string());
 }
 
 void Compiler::_importFunctionDeclarationStatement(AST::FunctionStatement* function_declaration_statement, RecordModule* module, compilationState::RecordFile* local_file_record) {
@@ -17,12 +17,17 @@
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <unordered_set>
 #include <vector>
 
 // === Project-specific Headers ===
 #include "../compilation_state.hpp"
 #include "../parser/AST/ast.hpp"
 #include "./enviornment/enviornment.hpp"
+#include "./interface.hpp"
+#include "./optimizer.hpp"
 
 namespace compiler {
 
@@ -157,13 +162,38 @@ class Compiler {
      * @param relativePath The relative path of the source file.
      * @param target_triple Optional target triple override (e.g. "aarch64-unknown-linux-gnu").
      *                      Empty string means use the host native target.
-     */
-    Compiler(const Str& source, const std::filesystem::path& file_path, compilationState::RecordFile* file_record, const std::filesystem::path& buildDir, const std::filesystem::path& relativePath, const Str& target_triple = "");
+     * @param shared_context Context to create the module in, shared with other compilers
+     *                       (`gigly --unity`); null gives the compiler a private one.
+     *                      A context must only be used by one thread at a time.
+     */
+    Compiler(const Str& source,
+             const std::filesystem::path& file_path,
+             compilationState::RecordFile* file_record,
+             const std::filesystem::path& buildDir,
+             const std::filesystem::path& relativePath,
+             const Str& target_triple = "",
+             llvm::LLVMContext* shared_context = nullptr);
 
     ~Compiler();
 
     std::function<void(const std::filesystem::path&)> compile_dependency_cb = nullptr;
 
+    /// Programs shared with the other files of the build; imported files are
+    /// loaded through it. When null every import is loaded privately.
+    compilationState::ASTCache* ast_cache = nullptr;
+
+    /// Declare pass of an import cycle: functions & methods are declared
+    /// without their bodies, which is all the module interface needs.
+    bool declarations_only = false;
+
+    /// The value of every expression statement is stored to a volatile local,
+    /// so optimization cannot remove the expression (`:time` of `gigly repl`).
+    bool sink_expression_values = false;
+
+    /// Imports (relative to src/) the declare pass leaves out because they sit
+    /// on the same cycle; their interfaces do not exist yet.
+    std::unordered_set<std::string> deferred_imports;
+
     // === Public Methods ===
 
     /**
@@ -172,6 +202,63 @@ class Compiler {
      */
     void compile(AST::Node* node);
 
+    /**
+     * @brief Runs the LLVM optimization pipeline over the compiled module.
+     *
+     * Does nothing when both the level and the pipeline are empty.
+     * @param optimization_level Level selecting the default pipeline ("0"-"3", "s", "z", "fast").
+     * @param pass_pipeline Textual pass pipeline that replaces the default one.
+     * @param lto Runs the LTO pre-link pipeline instead of the per-module one.
+     */
+    void optimize(const Str& optimization_level, const Str& pass_pipeline = "", LTOMode lto = LTOMode::None);
+
+    /**
+     * @brief Emits the compiled module as a native object file.
+     *
+     * Leases a TargetMachine for the module's triple from the TargetRegistry,
+     * so no textual IR has to be written or re-parsed.
+     * @param obj_path Path of the object file to write.
+     * @param optimization_level Code generation level ("", "0"-"3", "s", "z", "fast").
+     */
+    void emitObjectFile(const std::filesystem::path& obj_path, const Str& optimization_level = "");
+
+    /**
+     * @brief Writes the compiled module as LLVM bitcode for link time optimization.
+     * @param bc_path Path of the bitcode file to write.
+     * @param with_summary Embed the module summary ThinLTO needs.
+     */
+    void emitBitcodeFile(const std::filesystem::path& bc_path, bool with_summary = false);
+
+    /**
+     * @brief Replaces the source quoted by error messages.
+     *
+     * For `gigly repl`, which compiles every input with the same compiler.
+     */
+    void setSource(const Str& source) { this->source = source; }
+
+    /**
+     * @brief Moves what was compiled since the last call into a module of another context.
+     *
+     * For incremental compilation (`gigly repl`). Definitions stay behind as
+     * declarations, so the records of the environment keep pointing at valid
+     * functions and globals, and later input refers to them by name. Module
+     * local symbols are made external first for the same reason.
+     * @param context Context of the returned module.
+     */
+    std::unique_ptr<llvm::Module> takeIncrementalModule(llvm::LLVMContext& context);
+
+    /**
+     * @brief Copies the compiled module into another context, retargeted to another triple.
+     *
+     * For emitting one compilation for several targets (`gigc --target a,b`).
+     * Code generation only sees the target through the alignments its data
+     * layout gives loads, stores & allocas, so the copy is valid for any
+     * target with the same data layout string.
+     * @param context Context of the returned module, so each target can be lowered on a thread of its own.
+     * @param target_triple Triple of the copy; its data layout is set too.
+     */
+    std::unique_ptr<llvm::Module> cloneForTarget(llvm::LLVMContext& context, const Str& target_triple);
+
     /**
      * @brief Converts a type from one struct type to another.
      * @param from Tuple containing LLVM values and the source struct type.
@@ -198,12 +285,15 @@ class Compiler {
     bool conversionPrecidence(RecordStructType* from, RecordStructType* to);
 
     // --- LLVM Components ---
-    llvm::LLVMContext llvm_context;            ///< LLVM context
+    std::unique_ptr<llvm::LLVMContext> owned_llvm_context; ///< Owns llvm_context unless a shared context was given
+    llvm::LLVMContext& llvm_context;           ///< LLVM context
     std::unique_ptr<llvm::Module> llvm_module; ///< LLVM module; For code output purposes it is public
     llvm::IRBuilder<> llvm_ir_builder;         ///< LLVM IR builder
 
     compilationState::RecordFile* file_record;
 
+    ExportedNames exported_names; ///< LLVM names of the functions this file defines, written to its interface
+
   private:
     // === Member Variables ===
 
@@ -212,6 +302,8 @@ class Compiler {
     std::filesystem::path buildDir;     ///< Build directory path
     std::filesystem::path relativePath; ///< Relative path of the source file
     std::filesystem::path file_path;    ///< Full path of the source file
+    std::filesystem::path srcDir;       ///< Root of the sources, which import paths resolve under
+    std::filesystem::path importDir;    ///< Directory (relative to src/) of the file whose imports are being resolved
 
     // --- Naming Prefixes ---
     Str fc_st_name_prefix; ///< Prefix for function and struct names
@@ -250,6 +342,7 @@ class Compiler {
     RecordStructType* gc_raw_array = nullptr; ///< GC wrapper for raw_array
 
     std::vector<AST::Program*> auto_free_programs;
+    std::unordered_set<std::string> importing; ///< Imports (relative to src/) whose declarations are being added
     std::vector<RecordStructType*> auto_free_recordStructType;
 
     // === Private Methods ===
@@ -268,6 +361,11 @@ class Compiler {
      */
     void _initializeLLVMModule(const Str& path_str, const Str& target_triple);
 
+    /**
+     * @brief Verifies the LLVM module, raising a compilation error if it is invalid.
+     */
+    void _verifyModule();
+
     /**
      * @brief Initializes the compiler environment.
      */
@@ -0,0 +1,717 @@
+#include "interface.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../compilation_state.hpp"
+#include "../errors/errors.hpp"
+
+namespace compiler {
+
+namespace {
+
+constexpr char INTERFACE_MAGIC[4] = {'G', 'C', 'I', '\0'};
+// Bump whenever the encoding below changes
+constexpr uint32_t INTERFACE_VERSION = 1;
+constexpr size_t INTERFACE_HEADER_SIZE = sizeof(INTERFACE_MAGIC) + sizeof(uint32_t) + sizeof(uint64_t);
+
+template <typename Map, typename Fn> void forEachSorted(const Map& map, Fn fn) {
+    std::vector<const typename Map::value_type*> items;
+    for (const auto& item : map) items.push_back(&item);
+    std::sort(items.begin(), items.end(), [](auto a, auto b) { return a->first < b->first; });
+    for (auto item : items) fn(*item);
+}
+
+// Source positions the parser keeps in int_map (of meta_data.more_data & extra_info) rather than pos_map
+bool isPositionKey(const std::string& key) {
+    static const std::unordered_set<std::string> keys = {
+        "name_line_no", "name_col_no", "name_end_col_no",               // Variable declarations & struct fields
+        "operator_line_no", "operator_st_col_no", "operator_end_col_no", // Infix expressions
+        "index_line_no", "index_st_col_no", "index_end_col_no",          // Index expressions
+        "idx_stcol_no", "idx_endcol_no",                                 // break
+    };
+    return keys.contains(key);
+}
+
+/**
+ * @brief Encodes AST nodes into a little-endian byte buffer.
+ *
+ * With `with_positions == false` line/column information is left out, which
+ * gives the position independent encoding the interface hash is computed on:
+ * an edit that only moves a declaration keeps the hash.
+ */
+class InterfaceWriter {
+  public:
+    InterfaceWriter(bool with_positions, const ExportedNames* exported_names = nullptr) : with_positions(with_positions), exported_names(exported_names) {}
+
+    std::string buffer;
+
+    void u8(uint8_t value) { buffer.push_back(static_cast<char>(value)); }
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) u8(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) u8(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    void i32(int value) { u32(static_cast<uint32_t>(value)); }
+    void i64(long long value) { u64(static_cast<uint64_t>(value)); }
+    void str(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        buffer += value;
+    }
+
+    void moreData(const AST::MoreData& data) {
+        size_t positions = with_positions ? 0 : std::count_if(data.int_map.begin(), data.int_map.end(), [](const auto& item) { return isPositionKey(item.first); });
+        u32(static_cast<uint32_t>(data.int_map.size() - positions));
+        forEachSorted(data.int_map, [this](const auto& item) {
+            if (!with_positions && isPositionKey(item.first)) return;
+            str(item.first);
+            i32(item.second);
+        });
+        u32(static_cast<uint32_t>(data.str_map.size()));
+        forEachSorted(data.str_map, [this](const auto& item) {
+            str(item.first);
+            str(item.second);
+        });
+        if (with_positions) {
+            u32(static_cast<uint32_t>(data.pos_map.size()));
+            forEachSorted(data.pos_map, [this](const auto& item) {
+                str(item.first);
+                i32(std::get<0>(item.second));
+                i32(std::get<1>(item.second));
+            });
+        }
+        u32(static_cast<uint32_t>(data.bool_map.size()));
+        forEachSorted(data.bool_map, [this](const auto& item) {
+            str(item.first);
+            u8(item.second);
+        });
+    }
+
+    template <typename T> void nodes(const std::vector<T*>& list) {
+        u32(static_cast<uint32_t>(list.size()));
+        for (auto item : list) node(item);
+    }
+
+    void node(AST::Node* node) {
+        if (!node) {
+            u8(0);
+            return;
+        }
+        u8(static_cast<uint8_t>(node->type()) + 1);
+        if (with_positions) {
+            i32(node->meta_data.st_line_no);
+            i32(node->meta_data.st_col_no);
+            i32(node->meta_data.end_line_no);
+            i32(node->meta_data.end_col_no);
+        }
+        moreData(node->meta_data.more_data);
+        moreData(exportedInfo(node));
+
+        switch (node->type()) {
+            case AST::NodeType::Type: {
+                auto type = node->castToType();
+                this->node(type->name);
+                nodes(type->generics);
+                u8(type->refrence);
+                break;
+            }
+            case AST::NodeType::Program:
+                nodes(node->castToProgram()->statements);
+                break;
+            case AST::NodeType::ExpressionStatement:
+                this->node(node->castToExpressionStatement()->expr);
+                break;
+            case AST::NodeType::BlockStatement:
+                nodes(node->castToBlockStatement()->statements);
+                break;
+            case AST::NodeType::ReturnStatement:
+                this->node(node->castToReturnStatement()->value);
+                break;
+            case AST::NodeType::RaiseStatement:
+                this->node(node->castToRaiseStatement()->value);
+                break;
+            case AST::NodeType::FunctionParameter: {
+                auto parameter = node->castToFunctionParameter();
+                this->node(parameter->name);
+                this->node(parameter->value_type);
+                u8(parameter->constant);
+                break;
+            }
+            case AST::NodeType::FunctionStatement: {
+                auto function = node->castToFunctionStatement();
+                this->node(function->name);
+                nodes(function->parameters);
+                nodes(function->closure_parameters);
+                this->node(function->return_type);
+                u8(function->return_const);
+                // Importers only need the signature, except for generics which are instantiated from the body
+                bool keep_body = !function->generic.empty() || generic_depth > 0;
+                this->node(keep_body ? function->body : nullptr);
+                nodes(function->generic);
+                break;
+            }
+            case AST::NodeType::CallExpression: {
+                auto call = node->castToCallExpression();
+                this->node(call->name);
+                nodes(call->arguments);
+                nodes(call->generics);
+                u8(call->_new);
+                break;
+            }
+            case AST::NodeType::IfElseStatement: {
+                auto if_else = node->castToIfElseStatement();
+                this->node(if_else->condition);
+                this->node(if_else->consequence);
+                this->node(if_else->alternative);
+                break;
+            }
+            case AST::NodeType::WhileStatement: {
+                auto while_statement = node->castToWhileStatement();
+                this->node(while_statement->condition);
+                this->node(while_statement->body);
+                this->node(while_statement->ifbreak);
+                this->node(while_statement->notbreak);
+                break;
+            }
+            case AST::NodeType::ForStatement: {
+                auto for_statement = node->castToForStatement();
+                this->node(for_statement->init);
+                this->node(for_statement->condition);
+                this->node(for_statement->update);
+                this->node(for_statement->body);
+                this->node(for_statement->ifbreak);
+                this->node(for_statement->notbreak);
+                break;
+            }
+            case AST::NodeType::ForEachStatement: {
+                auto for_each = node->castToForEachStatement();
+                this->node(for_each->get);
+                this->node(for_each->from);
+                this->node(for_each->body);
+                this->node(for_each->ifbreak);
+                this->node(for_each->notbreak);
+                break;
+            }
+            case AST::NodeType::BreakStatement:
+                i32(static_cast<AST::BreakStatement*>(node)->loopIdx);
+                break;
+            case AST::NodeType::ContinueStatement:
+                i32(node->castToContinueStatement()->loopIdx);
+                break;
+            case AST::NodeType::ImportStatement: {
+                auto import_statement = node->castToImportStatement();
+                str(import_statement->relativePath);
+                str(import_statement->as);
+                break;
+            }
+            case AST::NodeType::VariableDeclarationStatement: {
+                auto declaration = node->castToVariableDeclarationStatement();
+                this->node(declaration->name);
+                this->node(declaration->value_type);
+                this->node(declaration->value);
+                u8(declaration->is_volatile);
+                u8(declaration->is_const);
+                break;
+            }
+            case AST::NodeType::VariableAssignmentStatement: {
+                auto assignment = node->castToVariableAssignmentStatement();
+                this->node(assignment->name);
+                this->node(assignment->value);
+                break;
+            }
+            case AST::NodeType::TryCatchStatement: {
+                auto try_catch = node->castToTryCatchStatement();
+                this->node(try_catch->try_block);
+                u32(static_cast<uint32_t>(try_catch->catch_blocks.size()));
+                for (const auto& [type, name, block] : try_catch->catch_blocks) {
+                    this->node(type);
+                    this->node(name);
+                    this->node(block);
+                }
+                break;
+            }
+            case AST::NodeType::SwitchCaseStatement: {
+                auto switch_case = node->castToSwitchCaseStatement();
+                this->node(switch_case->condition);
+                u32(static_cast<uint32_t>(switch_case->cases.size()));
+                for (const auto& [value, body] : switch_case->cases) {
+                    this->node(value);
+                    this->node(body);
+                }
+                this->node(switch_case->other);
+                break;
+            }
+            case AST::NodeType::InfixedExpression: {
+                auto infix = node->castToInfixExpression();
+                this->node(infix->left);
+                this->node(infix->right);
+                i32(static_cast<int>(infix->op));
+                break;
+            }
+            case AST::NodeType::IndexExpression: {
+                auto index = node->castToIndexExpression();
+                this->node(index->left);
+                this->node(index->index);
+                break;
+            }
+            case AST::NodeType::IntegerLiteral:
+                i64(node->castToIntegerLiteral()->value);
+                break;
+            case AST::NodeType::FloatLiteral:
+                u64(std::bit_cast<uint64_t>(node->castToFloatLiteral()->value));
+                break;
+            case AST::NodeType::BooleanLiteral:
+                u8(node->castToBooleanLiteral()->value);
+                break;
+            case AST::NodeType::StringLiteral:
+                str(node->castToStringLiteral()->value);
+                break;
+            case AST::NodeType::IdentifierLiteral:
+                str(node->castToIdentifierLiteral()->value);
+                break;
+            case AST::NodeType::ArrayLiteral: {
+                auto array = node->castToArrayLiteral();
+                nodes(array->elements);
+                u8(array->_new);
+                break;
+            }
+            case AST::NodeType::StructStatement: {
+                auto struct_statement = node->castToStructStatement();
+                this->node(struct_statement->name);
+                // Methods of generic structs are instantiated later, so they keep their bodies
+                bool generic = !struct_statement->generics.empty();
+                if (generic) generic_depth++;
+                nodes(struct_statement->fields);
+                if (generic) generic_depth--;
+                nodes(struct_statement->generics);
+                break;
+            }
+            case AST::NodeType::EnumStatement: {
+                auto enum_statement = node->castToEnumStatement();
+                this->node(enum_statement->name);
+                u32(static_cast<uint32_t>(enum_statement->fields.size()));
+                for (const auto& field : enum_statement->fields) str(field);
+                break;
+            }
+            case AST::NodeType::MacroStatement: {
+                auto macro = node->castToMacroStatement();
+                str(macro->name);
+                this->node(macro->body);
+                break;
+            }
+            default:
+                throw std::runtime_error("cannot encode " + AST::nodeTypeToString(node->type()) + " in a module interface");
+        }
+    }
+
+  private:
+    /**
+     * @brief extra_info of a node, plus the `ll_name` importers link against.
+     *
+     * Only concrete functions get one; generics are instantiated by the importer.
+     */
+    AST::MoreData exportedInfo(AST::Node* node) const {
+        if (!exported_names || generic_depth > 0 || node->type() != AST::NodeType::FunctionStatement) return node->extra_info;
+        auto function = node->castToFunctionStatement();
+        auto it = exported_names->find(function);
+        if (!function->generic.empty() || it == exported_names->end()) return node->extra_info;
+        AST::MoreData info = node->extra_info;
+        info.insert("ll_name", it->second);
+        return info;
+    }
+
+    bool with_positions;
+    const ExportedNames* exported_names;
+    int generic_depth = 0;
+};
+
+/**
+ * @brief Decodes what InterfaceWriter wrote with positions.
+ *
+ * Throws std::runtime_error on truncated or malformed input.
+ */
+class InterfaceReader {
+  public:
+    InterfaceReader(const std::string& data, size_t pos) : data(data), pos(pos) {}
+
+    uint8_t u8() {
+        need(1);
+        return static_cast<uint8_t>(data[pos++]);
+    }
+    uint32_t u32() {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(u8()) << (8 * i);
+        return value;
+    }
+    uint64_t u64() {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(u8()) << (8 * i);
+        return value;
+    }
+    int i32() { return static_cast<int>(u32()); }
+    long long i64() { return static_cast<long long>(u64()); }
+    bool boolean() { return u8() != 0; }
+    std::string str() {
+        uint32_t size = u32();
+        need(size);
+        std::string value = data.substr(pos, size);
+        pos += size;
+        return value;
+    }
+
+    AST::MoreData moreData() {
+        AST::MoreData more_data;
+        for (uint32_t count = u32(); count > 0; --count) {
+            auto key = str();
+            more_data.int_map[key] = i32();
+        }
+        for (uint32_t count = u32(); count > 0; --count) {
+            auto key = str();
+            more_data.str_map[key] = str();
+        }
+        for (uint32_t count = u32(); count > 0; --count) {
+            auto key = str();
+            int first = i32();
+            int second = i32();
+            more_data.pos_map[key] = {first, second};
+        }
+        for (uint32_t count = u32(); count > 0; --count) {
+            auto key = str();
+            more_data.bool_map[key] = boolean();
+        }
+        return more_data;
+    }
+
+    template <typename T> std::vector<T*> nodes() {
+        std::vector<T*> list;
+        for (uint32_t count = u32(); count > 0; --count) list.push_back(nodeAs<T>());
+        return list;
+    }
+
+    template <typename T> T* nodeAs() { return static_cast<T*>(node()); }
+
+    AST::Node* node() {
+        uint8_t tag = u8();
+        if (tag == 0) return nullptr;
+        auto type = static_cast<AST::NodeType>(tag - 1);
+
+        AST::MetaData meta_data;
+        meta_data.st_line_no = i32();
+        meta_data.st_col_no = i32();
+        meta_data.end_line_no = i32();
+        meta_data.end_col_no = i32();
+        meta_data.more_data = moreData();
+        AST::MoreData extra_info = moreData();
+
+        // Children are read into locals first: argument evaluation order is unspecified
+        AST::Node* result = nullptr;
+        switch (type) {
+            case AST::NodeType::Type: {
+                auto name = nodeAs<AST::Expression>();
+                auto generics = nodes<AST::Type>();
+                bool refrence = boolean();
+                result = new AST::Type(name, generics, refrence);
+                break;
+            }
+            case AST::NodeType::Program: {
+                auto program = new AST::Program();
+                program->statements = nodes<AST::Statement>();
+                result = program;
+                break;
+            }
+            case AST::NodeType::ExpressionStatement:
+                result = new AST::ExpressionStatement(nodeAs<AST::Expression>());
+                break;
+            case AST::NodeType::BlockStatement:
+                result = new AST::BlockStatement(nodes<AST::Statement>());
+                break;
+            case AST::NodeType::ReturnStatement:
+                result = new AST::ReturnStatement(nodeAs<AST::Expression>());
+                break;
+            case AST::NodeType::RaiseStatement:
+                result = new AST::RaiseStatement(nodeAs<AST::Expression>());
+                break;
+            case AST::NodeType::FunctionParameter: {
+                auto name = nodeAs<AST::Expression>();
+                auto value_type = nodeAs<AST::Type>();
+                bool constant = boolean();
+                result = new AST::FunctionParameter(name, value_type, constant);
+                break;
+            }
+            case AST::NodeType::FunctionStatement: {
+                auto name = nodeAs<AST::Expression>();
+                auto parameters = nodes<AST::FunctionParameter>();
+                auto closure_parameters = nodes<AST::FunctionParameter>();
+                auto return_type = nodeAs<AST::Type>();
+                bool return_const = boolean();
+                auto body = nodeAs<AST::BlockStatement>();
+                auto generic = nodes<AST::Type>();
+                result = new AST::FunctionStatement(name, parameters, closure_parameters, return_type, return_const, body, generic);
+                break;
+            }
+            case AST::NodeType::CallExpression: {
+                auto name = nodeAs<AST::Expression>();
+                auto arguments = nodes<AST::Expression>();
+                auto call = new AST::CallExpression(name, arguments);
+                call->generics = nodes<AST::Expression>();
+                call->_new = boolean();
+                result = call;
+                break;
+            }
+            case AST::NodeType::IfElseStatement: {
+                auto condition = nodeAs<AST::Expression>();
+                auto consequence = nodeAs<AST::Statement>();
+                auto alternative = nodeAs<AST::Statement>();
+                result = new AST::IfElseStatement(condition, consequence, alternative);
+                break;
+            }
+            case AST::NodeType::WhileStatement: {
+                auto condition = nodeAs<AST::Expression>();
+                auto body = nodeAs<AST::Statement>();
+                auto ifbreak = nodeAs<AST::Statement>();
+                auto notbreak = nodeAs<AST::Statement>();
+                result = new AST::WhileStatement(condition, body, ifbreak, notbreak);
+                break;
+            }
+            case AST::NodeType::ForStatement: {
+                auto init = nodeAs<AST::Statement>();
+                auto condition = nodeAs<AST::Expression>();
+                auto update = nodeAs<AST::Statement>();
+                auto body = nodeAs<AST::Statement>();
+                auto ifbreak = nodeAs<AST::Statement>();
+                auto notbreak = nodeAs<AST::Statement>();
+                result = new AST::ForStatement(init, condition, update, body, ifbreak, notbreak);
+                break;
+            }
+            case AST::NodeType::ForEachStatement: {
+                auto get = nodeAs<AST::IdentifierLiteral>();
+                auto from = nodeAs<AST::Expression>();
+                auto body = nodeAs<AST::Statement>();
+                auto ifbreak = nodeAs<AST::Statement>();
+                auto notbreak = nodeAs<AST::Statement>();
+                result = new AST::ForEachStatement(get, from, body, ifbreak, notbreak);
+                break;
+            }
+            case AST::NodeType::BreakStatement:
+                result = new AST::BreakStatement(i32());
+                break;
+            case AST::NodeType::ContinueStatement:
+                result = new AST::ContinueStatement(i32());
+                break;
+            case AST::NodeType::ImportStatement: {
+                auto relative_path = str();
+                auto as = str();
+                result = new AST::ImportStatement(relative_path, as);
+                break;
+            }
+            case AST::NodeType::VariableDeclarationStatement: {
+                auto name = nodeAs<AST::Expression>();
+                auto value_type = nodeAs<AST::Type>();
+                auto value = nodeAs<AST::Expression>();
+                bool is_volatile = boolean();
+                bool is_const = boolean();
+                result = new AST::VariableDeclarationStatement(name, value_type, value, is_volatile, is_const);
+                break;
+            }
+            case AST::NodeType::VariableAssignmentStatement: {
+                auto name = nodeAs<AST::Expression>();
+                auto value = nodeAs<AST::Expression>();
+                result = new AST::VariableAssignmentStatement(name, value);
+                break;
+            }
+            case AST::NodeType::TryCatchStatement: {
+                auto try_block = nodeAs<AST::Statement>();
+                std::vector<std::tuple<AST::Type*, AST::IdentifierLiteral*, AST::Statement*>> catch_blocks;
+                for (uint32_t count = u32(); count > 0; --count) {
+                    auto catch_type = nodeAs<AST::Type>();
+                    auto name = nodeAs<AST::IdentifierLiteral>();
+                    auto block = nodeAs<AST::Statement>();
+                    catch_blocks.emplace_back(catch_type, name, block);
+                }
+                result = new AST::TryCatchStatement(try_block, catch_blocks);
+                break;
+            }
+            case AST::NodeType::SwitchCaseStatement: {
+                auto condition = nodeAs<AST::Expression>();
+                std::vector<std::tuple<AST::Expression*, AST::Statement*>> cases;
+                for (uint32_t count = u32(); count > 0; --count) {
+                    auto value = nodeAs<AST::Expression>();
+                    auto body = nodeAs<AST::Statement>();
+                    cases.emplace_back(value, body);
+                }
+                auto other = nodeAs<AST::Statement>();
+                result = new AST::SwitchCaseStatement(condition, cases, other);
+                break;
+            }
+            case AST::NodeType::InfixedExpression: {
+                auto left = nodeAs<AST::Expression>();
+                auto right = nodeAs<AST::Expression>();
+                auto op = static_cast<token::TokenType>(i32());
+                // The operator literal is restored with the rest of the metadata below
+                result = new AST::InfixExpression(left, op, "", right);
+                break;
+            }
+            case AST::NodeType::IndexExpression: {
+                auto left = nodeAs<AST::Expression>();
+                auto index = nodeAs<AST::Expression>();
+                result = new AST::IndexExpression(left, index);
+                break;
+            }
+            case AST::NodeType::IntegerLiteral:
+                result = new AST::IntegerLiteral(i64());
+                break;
+            case AST::NodeType::FloatLiteral:
+                result = new AST::FloatLiteral(std::bit_cast<double>(u64()));
+                break;
+            case AST::NodeType::BooleanLiteral:
+                result = new AST::BooleanLiteral(boolean());
+                break;
+            case AST::NodeType::StringLiteral:
+                result = new AST::StringLiteral(str());
+                break;
+            case AST::NodeType::IdentifierLiteral: {
+                token::Token token(token::TokenType::Identifier, str(), 0, 0, 0, 0);
+                result = new AST::IdentifierLiteral(token);
+                break;
+            }
+            case AST::NodeType::ArrayLiteral: {
+                auto elements = nodes<AST::Expression>();
+                bool is_new = boolean();
+                result = new AST::ArrayLiteral(elements, is_new);
+                break;
+            }
+            case AST::NodeType::StructStatement: {
+                auto name = nodeAs<AST::Expression>();
+                auto fields = nodes<AST::Statement>();
+                auto struct_statement = new AST::StructStatement(name, fields);
+                struct_statement->generics = nodes<AST::Type>();
+                result = struct_statement;
+                break;
+            }
+            case AST::NodeType::EnumStatement: {
+                auto name = nodeAs<AST::Expression>();
+                std::vector<std::string> fields;
+                for (uint32_t count = u32(); count > 0; --count) fields.push_back(str());
+                result = new AST::EnumStatement(name, fields);
+                break;
+            }
+            case AST::NodeType::MacroStatement: {
+                auto name = str();
+                auto body = nodeAs<AST::BlockStatement>();
+                result = new AST::MacroStatement(name, body);
+                break;
+            }
+            default:
+                throw std::runtime_error("unexpected node in module interface");
+        }
+        result->meta_data = meta_data;
+        result->extra_info = extra_info;
+        return result;
+    }
+
+  private:
+    void need(size_t size) const {
+        if (pos + size > data.size()) throw std::runtime_error("truncated module interface");
+    }
+
+    const std::string& data;
+    size_t pos;
+};
+
+// Top-level statements an importer looks at
+bool isExported(AST::Statement* statement) {
+    switch (statement->type()) {
+        case AST::NodeType::FunctionStatement:
+        case AST::NodeType::StructStatement:
+        case AST::NodeType::EnumStatement:
+        case AST::NodeType::ImportStatement:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint64_t decodeHeader(const std::string& data) {
+    if (data.size() < INTERFACE_HEADER_SIZE || data.compare(0, sizeof(INTERFACE_MAGIC), INTERFACE_MAGIC, sizeof(INTERFACE_MAGIC)) != 0) {
+        throw std::runtime_error("not a module interface");
+    }
+    InterfaceReader reader(data, sizeof(INTERFACE_MAGIC));
+    if (reader.u32() != INTERFACE_VERSION) throw std::runtime_error("module interface from another compiler version");
+    return reader.u64();
+}
+
+} // namespace
+
+std::filesystem::path interfacePath(const std::filesystem::path& buildDir, const std::filesystem::path& relative) {
+    return buildDir / "interface" / (relative.lexically_normal().string() + ".gci");
+}
+
+uint64_t writeInterface(AST::Program* program, const ExportedNames& exported_names, const std::filesystem::path& path) {
+    InterfaceWriter body(true, &exported_names);
+    InterfaceWriter hashed(false, &exported_names);
+    std::vector<AST::Statement*> exported;
+    for (auto statement : program->statements) {
+        if (isExported(statement)) exported.push_back(statement);
+    }
+    body.nodes(exported);
+    hashed.nodes(exported);
+    uint64_t interface_hash = Utils::computeHash(hashed.buffer);
+
+    InterfaceWriter header(true);
+    header.buffer.append(INTERFACE_MAGIC, sizeof(INTERFACE_MAGIC));
+    header.u32(INTERFACE_VERSION);
+    header.u64(interface_hash);
+
+    Utils::createDirectories(path.parent_path());
+    // Write next to the target and rename, so a concurrent reader never sees half a file
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) { errors::raiseCompilationError("Could not write module interface " + path.string()); }
+        file << header.buffer << body.buffer;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) { errors::raiseCompilationError("Could not write module interface " + path.string() + ": " + ec.message()); }
+    return interface_hash;
+}
+
+AST::Program* readInterface(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return nullptr;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    std::string data = contents.str();
+    try {
+        decodeHeader(data);
+        InterfaceReader reader(data, INTERFACE_HEADER_SIZE);
+        auto program = new AST::Program();
+        program->statements = reader.nodes<AST::Statement>();
+        return program;
+    } catch (const std::runtime_error&) {
+        // The caller falls back to parsing the source
+        return nullptr;
+    }
+}
+
+std::optional<uint64_t> readInterfaceHash(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return std::nullopt;
+    std::string header(INTERFACE_HEADER_SIZE, '\0');
+    if (!file.read(header.data(), header.size())) return std::nullopt;
+    try {
+        return decodeHeader(header);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace compiler
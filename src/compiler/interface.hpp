@@ -0,0 +1,70 @@
+#ifndef INTERFACE_HPP
+#define INTERFACE_HPP
+
+/**
+ * @file interface.hpp
+ * @brief Binary module interface files (`.gci`).
+ *
+ * After a module is compiled its declarations are written to
+ * `build/interface/<file>.gc.gci`: imports, functions and struct methods
+ * without their bodies (annotated with the LLVM name they were emitted
+ * under), struct layouts, enums, and the full AST of generic functions and
+ * structs. Importers load this file instead of lexing and parsing the
+ * imported source again.
+ *
+ * The header carries an interface hash computed without source positions,
+ * so editing a function body leaves the hash, and therefore the importers'
+ * objects, unchanged.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "../parser/AST/ast.hpp"
+
+namespace compiler {
+
+/**
+ * @brief LLVM names of the functions a module defines, keyed by their declaration.
+ *
+ * Kept outside the AST so programs stay untouched by code generation.
+ */
+using ExportedNames = std::unordered_map<const AST::FunctionStatement*, std::string>;
+
+/**
+ * @brief Location of the interface file of a source file.
+ * @param buildDir The build directory.
+ * @param relative Path of the source file relative to the source directory.
+ */
+std::filesystem::path interfacePath(const std::filesystem::path& buildDir, const std::filesystem::path& relative);
+
+/**
+ * @brief Writes the interface of a compiled program.
+ *
+ * @param program The compiled program.
+ * @param exported_names LLVM names Compiler::compile gave its functions.
+ * @param path The interface file to write.
+ * @return The interface hash.
+ */
+uint64_t writeInterface(AST::Program* program, const ExportedNames& exported_names, const std::filesystem::path& path);
+
+/**
+ * @brief Loads an interface file.
+ *
+ * @param path The interface file.
+ * @return A program holding the exported declarations, owned by the caller,
+ *         or nullptr if the file is missing, corrupt or from another version.
+ */
+AST::Program* readInterface(const std::filesystem::path& path);
+
+/**
+ * @brief Reads only the interface hash from the header of an interface file.
+ */
+std::optional<uint64_t> readInterfaceHash(const std::filesystem::path& path);
+
+} // namespace compiler
+
+#endif // INTERFACE_HPP
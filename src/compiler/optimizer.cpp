@@ -0,0 +1,74 @@
+#include "optimizer.hpp"
+
+#include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Analysis/LoopAnalysisManager.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/Error.h>
+
+#include "../errors/errors.hpp"
+#include "../time_trace.hpp"
+
+namespace compiler {
+
+std::optional<LTOMode> parseLTOMode(const std::string& lto) {
+    if (lto.empty()) return LTOMode::None;
+    if (lto == "full") return LTOMode::Full;
+    if (lto == "thin") return LTOMode::Thin;
+    return std::nullopt;
+}
+
+std::optional<llvm::OptimizationLevel> parseOptimizationLevel(const std::string& optimization_level) {
+    if (optimization_level == "0") return llvm::OptimizationLevel::O0;
+    if (optimization_level == "1") return llvm::OptimizationLevel::O1;
+    if (optimization_level == "2") return llvm::OptimizationLevel::O2;
+    if (optimization_level == "3" || optimization_level == "fast") return llvm::OptimizationLevel::O3;
+    if (optimization_level == "s") return llvm::OptimizationLevel::Os;
+    if (optimization_level == "z") return llvm::OptimizationLevel::Oz;
+    return std::nullopt;
+}
+
+llvm::CodeGenOptLevel codeGenOptLevel(const std::string& optimization_level) {
+    if (optimization_level == "1") return llvm::CodeGenOptLevel::Less;
+    if (optimization_level == "2" || optimization_level == "s" || optimization_level == "z") return llvm::CodeGenOptLevel::Default;
+    if (optimization_level == "3" || optimization_level == "fast") return llvm::CodeGenOptLevel::Aggressive;
+    return llvm::CodeGenOptLevel::None;
+}
+
+void optimizeModule(llvm::Module& module, llvm::TargetMachine* target_machine, const std::string& optimization_level, const std::string& pass_pipeline, LTOMode lto) {
+    if (optimization_level.empty() && pass_pipeline.empty()) return;
+    timeTrace::Scope trace("Optimize", module.getSourceFileName());
+
+    llvm::LoopAnalysisManager loop_am;
+    llvm::FunctionAnalysisManager function_am;
+    llvm::CGSCCAnalysisManager cgscc_am;
+    llvm::ModuleAnalysisManager module_am;
+
+    llvm::PassBuilder pass_builder(target_machine);
+    pass_builder.registerModuleAnalyses(module_am);
+    pass_builder.registerCGSCCAnalyses(cgscc_am);
+    pass_builder.registerFunctionAnalyses(function_am);
+    pass_builder.registerLoopAnalyses(loop_am);
+    pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+
+    llvm::ModulePassManager module_pm;
+    if (!pass_pipeline.empty()) {
+        if (auto err = pass_builder.parsePassPipeline(module_pm, pass_pipeline)) {
+            errors::raiseCompilationError("Invalid pass pipeline '" + pass_pipeline + "': " + llvm::toString(std::move(err)));
+        }
+    } else {
+        auto level = parseOptimizationLevel(optimization_level);
+        if (!level) { errors::raiseCompilationError("Unknown optimization level '" + optimization_level + "'", "Use one of 0, 1, 2, 3, s, z or fast."); }
+        if (lto == LTOMode::None) {
+            module_pm = *level == llvm::OptimizationLevel::O0 ? pass_builder.buildO0DefaultPipeline(*level) : pass_builder.buildPerModuleDefaultPipeline(*level);
+        } else if (*level == llvm::OptimizationLevel::O0) {
+            module_pm = pass_builder.buildO0DefaultPipeline(*level, lto == LTOMode::Thin ? llvm::ThinOrFullLTOPhase::ThinLTOPreLink : llvm::ThinOrFullLTOPhase::FullLTOPreLink);
+        } else {
+            // Inlining & interprocedural passes are left for the link step, which sees every module
+            module_pm = lto == LTOMode::Thin ? pass_builder.buildThinLTOPreLinkDefaultPipeline(*level) : pass_builder.buildLTOPreLinkDefaultPipeline(*level);
+        }
+    }
+    module_pm.run(module, module_am);
+}
+
+} // namespace compiler
@@ -0,0 +1,63 @@
+#ifndef OPTIMIZER_HPP
+#define OPTIMIZER_HPP
+
+/**
+ * @file optimizer.hpp
+ * @brief In-process LLVM optimization pipeline for compiled modules.
+ *
+ * Optimization levels use the same spelling as the `-O` command line option:
+ * "0", "1", "2", "3", "s", "z" and "fast" (an alias of "3"). An empty level
+ * means the IR is left untouched.
+ */
+
+#include <llvm/IR/Module.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Target/TargetMachine.h>
+#include <optional>
+#include <string>
+
+namespace compiler {
+
+/**
+ * @enum LTOMode
+ * @brief Link time optimization mode, as selected with `gigly --lto`.
+ */
+enum class LTOMode {
+    None, ///< Every module is optimized and lowered on its own
+    Full, ///< Modules are merged and optimized as one at link time
+    Thin  ///< Modules carry summaries; ThinLTO imports across them at link time
+};
+
+/**
+ * @brief Parses an `--lto` mode ("", "full" or "thin").
+ * @return The mode, or std::nullopt if the spelling is unknown.
+ */
+std::optional<LTOMode> parseLTOMode(const std::string& lto);
+
+/**
+ * @brief Parses an `-O` level.
+ * @return The level, or std::nullopt if the spelling is unknown.
+ */
+std::optional<llvm::OptimizationLevel> parseOptimizationLevel(const std::string& optimization_level);
+
+/**
+ * @brief Maps an `-O` level to the matching code generation level.
+ */
+llvm::CodeGenOptLevel codeGenOptLevel(const std::string& optimization_level);
+
+/**
+ * @brief Runs the new pass manager pipeline over a module.
+ *
+ * @param module The module to optimize in place.
+ * @param target_machine Target used for target-aware analyses; may be null.
+ * @param optimization_level `-O` level selecting the default pipeline.
+ * @param pass_pipeline Optional textual pipeline (e.g. "function(mem2reg,instcombine)")
+ *                      used instead of the default pipeline for the level.
+ * @param lto With LTO the pre-link pipeline runs instead, leaving the rest to link time.
+ */
+void optimizeModule(llvm::Module& module, llvm::TargetMachine* target_machine, const std::string& optimization_level, const std::string& pass_pipeline = "", LTOMode lto = LTOMode::None);
+
+} // namespace compiler
+
+#endif // OPTIMIZER_HPP
@@ -6,21 +6,30 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/Support/FileSystem.h>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Include project headers
+#include "build_graph.hpp"
 #include "compilation_state.hpp"
+#include "compiler/codegen.hpp"
 #include "compiler/compiler.hpp"
+#include "compiler/interface.hpp"
+#include "compiler/optimizer.hpp"
 #include "errors/errors.hpp"
 #include "include/cli11.hpp"
 #include "lexer/lexer.hpp"
 #include "parser/parser.hpp"
+#include "time_trace.hpp"
 
 #define DEBUG_LEXER
 #define DEBUG_PARSER
@@ -35,7 +44,7 @@ void debugLexer(const std::string& fileContent, const std::filesystem::path& fil
         std::cerr << "Error: Could not open debug output file " << outputPath.string() << std::endl;
         return;
     }
-    while (debugLexer.current_char != "") {
+    while (static_cast<size_t>(debugLexer.pos) < debugLexer.source.size()) {
         token::Token token = debugLexer.nextToken();
         debugOutput << token.toString(false) << std::endl;
     }
@@ -43,11 +52,8 @@ void debugLexer(const std::string& fileContent, const std::filesystem::path& fil
 }
 
 // Helper to debug Parser
-void debugParser(const std::string& fileContent, const std::filesystem::path& file_path, const std::filesystem::path& buildDir) {
+void debugParser(AST::Program* program, const std::filesystem::path& buildDir) {
 #ifdef DEBUG_PARSER
-    Lexer debug_lexer(fileContent, file_path);
-    parser::Parser debugParser(&debug_lexer);
-    auto program = debugParser.parseProgram();
     std::filesystem::path outputPath = buildDir / "parser_output.yaml";
     std::ofstream file(outputPath, std::ios::trunc);
     if (file) {
@@ -55,50 +61,151 @@ void debugParser(const std::string& fileContent, const std::filesystem::path& fi
     } else {
         errors::raiseCompilationError("Unable to open parser debug output file: " + outputPath.string());
     }
-    delete program;
 #endif
 }
 
+// Options shared by the input file and every dependency it pulls in
+struct FrontendOptions {
+    std::string optimizationLevel; // "" = leave the IR as generated
+    std::string passPipeline;      // custom pass pipeline, replaces the -O pipeline
+    bool dumpOptIR = false;        // write IR before & after optimization to build/opt-ir
+    bool emitLLVMOnly = false;
+    bool emitBCOnly = false;       // bitcode instead of an object file
+    bool verbose = false;
+    std::string target_triple; // the frontend compiles for it; empty = native
+    std::vector<std::string> target_triples; // every --target; with more than one, each output is emitted once per target
+    bool timeTrace = false;    // write a Chrome trace to build/time-trace.json
+    size_t timeTraceTop = 10;  // files & functions listed in the time trace summary
+    bool writeDepfile = false;     // -MD: list the files the output depends on for make & ninja
+    std::filesystem::path depfile; // -MF: where; empty = the output with .d
+};
+
+// Helper to write the textual IR of a module
+void writeModuleIR(const llvm::Module& module, const std::filesystem::path& path) {
+    timeTrace::Scope trace("Print IR", path.string());
+    if (!path.parent_path().empty()) Utils::createDirectories(path.parent_path());
+    std::error_code EC;
+    llvm::raw_fd_ostream irFile(path.string(), EC, llvm::sys::fs::OF_None);
+    if (EC) { errors::raiseCompilationError("Could not open IR file " + path.string() + ": " + EC.message()); }
+    module.print(irFile, nullptr);
+}
+
+// Output of one of several targets: the triple goes before the extension (main.o -> main.aarch64-linux-gnu.o)
+std::filesystem::path targetOutputPath(std::filesystem::path path, const std::string& triple) {
+    std::string extension = path.extension().string();
+    return path.replace_extension("." + triple + extension);
+}
+
+// Targets sharing a class can share one module: the generated IR depends on the target only through its
+// data layout, whose alignments end up in allocas, loads & stores (x86_64 and aarch64 already differ there)
+std::string layoutClass(const std::string& triple) {
+    auto layout = compiler::TargetRegistry::instance().dataLayout(compiler::TargetKey{triple});
+    // Unknown targets get a class of their own; lowering reports them
+    if (!layout) return triple;
+    return layout->getStringRepresentation();
+}
+
+// Emits a compiled file once per --target. The frontend's module serves every target with its data layout;
+// `recompile` generates the IR again, from the same AST, for the other classes. Optimization & lowering run
+// for all targets in parallel, each on a copy of the module in a context of its own.
+void emitForTargets(compiler::Compiler& frontend,
+                    const std::function<std::unique_ptr<compiler::Compiler>(const std::string&)>& recompile,
+                    const FrontendOptions& options,
+                    const std::filesystem::path& outputPath,
+                    const std::filesystem::path& buildDir,
+                    const std::filesystem::path& relative) {
+    struct TargetJob {
+        std::string triple;
+        std::filesystem::path outputPath;
+        std::unique_ptr<llvm::LLVMContext> context;
+        std::unique_ptr<llvm::Module> module;
+    };
+
+    std::unordered_map<std::string, compiler::Compiler*> byLayout = {{layoutClass(options.target_triple), &frontend}};
+    std::vector<std::unique_ptr<compiler::Compiler>> regenerated;
+    std::vector<TargetJob> jobs;
+    // Copies are made here: every source module lives in a context this thread owns
+    for (const auto& triple : options.target_triples) {
+        compiler::Compiler*& source = byLayout[layoutClass(triple)];
+        if (!source) {
+            timeTrace::Scope trace("Regenerate IR", relative.string() + " for " + triple);
+            regenerated.push_back(recompile(triple));
+            source = regenerated.back().get();
+        }
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = source->cloneForTarget(*context, triple);
+        jobs.push_back({triple, targetOutputPath(outputPath, triple), std::move(context), std::move(module)});
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& job : jobs) {
+        threads.emplace_back([&job, &options, &buildDir, &relative]() {
+            timeTrace::Scope trace("Emit target", job.triple);
+            auto target_machine = compiler::acquireTargetMachine(job.triple);
+            auto dumpPath = [&](const std::string& stage) { return buildDir / "opt-ir" / job.triple / (relative.string() + stage); };
+            if (options.dumpOptIR) writeModuleIR(*job.module, dumpPath(".before.ll"));
+            if (!options.optimizationLevel.empty() || !options.passPipeline.empty()) {
+                compiler::optimizeModule(*job.module, target_machine.get(), options.optimizationLevel, options.passPipeline);
+            }
+            if (options.dumpOptIR) writeModuleIR(*job.module, dumpPath(".after.ll"));
+
+            if (options.emitLLVMOnly) writeModuleIR(*job.module, job.outputPath);
+            else if (options.emitBCOnly) compiler::emitBitcodeFile(*job.module, job.outputPath);
+            else compiler::emitObjectFile(*job.module, target_machine.get(), job.outputPath, options.optimizationLevel);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
 // Recursive compilation function
 void compileSingleFile(const std::filesystem::path& filePath,
                        const std::filesystem::path& srcDir,
                        const std::filesystem::path& buildDir,
-                       const std::string& optimizationLevel,
-                       bool verbose,
+                       const FrontendOptions& options,
                        compilationState::RecordFolder* rootFolder,
-                       const std::filesystem::path& customOutput = "",
-                       bool emitLLVMOnly = false,
-                       const std::string& target_triple = "") {
+                       compilationState::ASTCache& astCache,
+                       const std::filesystem::path& customOutput = "") {
+    const bool emitLLVMOnly = options.emitLLVMOnly;
+    const bool emitBCOnly = options.emitBCOnly && !emitLLVMOnly;
+    const bool verbose = options.verbose;
     auto relative = std::filesystem::relative(filePath, srcDir);
     std::filesystem::path outputIRPath = buildDir / "ir" / (relative.string() + ".ll");
+    std::filesystem::path outputBCPath = buildDir / "bc" / (relative.string() + ".bc");
     std::filesystem::path objFilePath = buildDir / "obj" / (relative.string() + ".o");
 
     if (!customOutput.empty()) {
         if (emitLLVMOnly || customOutput.extension() == ".ll") {
             outputIRPath = customOutput;
+        } else if (emitBCOnly || customOutput.extension() == ".bc") {
+            outputBCPath = customOutput;
         } else {
             objFilePath = customOutput;
         }
     }
+    const std::filesystem::path& outputPath = emitLLVMOnly ? outputIRPath : (emitBCOnly ? outputBCPath : objFilePath);
 
     if (verbose) {
-        std::cout << "Compiling: " << filePath << "\n"
-                  << "  IR output: " << outputIRPath << "\n"
-                  << "  OBJ output: " << objFilePath << "\n";
+        std::cout << "Compiling: " << filePath << "\n";
+        if (emitLLVMOnly) std::cout << "  IR output: " << outputIRPath << "\n";
+        else if (emitBCOnly) std::cout << "  BC output: " << outputBCPath << "\n";
+        else std::cout << "  OBJ output: " << objFilePath << "\n";
+        if (options.target_triples.size() > 1) std::cout << "  once per target, the triple before the extension\n";
     }
 
-    // Ensure output directories exist
-    if (!outputIRPath.parent_path().empty()) {
-        Utils::createDirectories(outputIRPath.parent_path());
-    }
-    if (!objFilePath.parent_path().empty()) {
-        Utils::createDirectories(objFilePath.parent_path());
+    // Ensure the output directory exists
+    if (!outputPath.parent_path().empty()) {
+        Utils::createDirectories(outputPath.parent_path());
     }
 
-    // Fetch compilation record
+    // Fetch compilation record; skip files another import already compiled
     compilationState::RecordFile* fileRecord = findOrCreateFileRecord(rootFolder, relative);
+    if (!fileRecord->tryStart()) return;
+    // Dependencies compile inside their first importer, so their time is part of its total too
+    timeTrace::Scope trace(timeTrace::COMPILE_FILE, relative.string());
 
-    std::string fileContent = Utils::readFileToString(filePath);
+    // Read & parse once; importers of this file share the same program
+    const std::string& fileContent = astCache.source(filePath);
+    auto program = astCache.program(filePath);
 
     // Debugging hooks
 #ifdef DEBUG_LEXER
@@ -108,68 +215,182 @@ void compileSingleFile(const std::filesystem::path& filePath,
 #endif
 #ifdef DEBUG_PARSER
     if (filePath.filename() == "main.gc") {
-        debugParser(fileContent, filePath, buildDir);
+        debugParser(program, buildDir);
     }
 #endif
 
-    // Parse and compile to LLVM IR
-    Lexer lexer(fileContent, filePath);
-    parser::Parser parser(&lexer);
-    auto program = parser.parseProgram();
-
-    compiler::Compiler comp(fileContent, std::filesystem::absolute(filePath), fileRecord, buildDir, relative.string(), target_triple);
+    // Compile to LLVM IR
+    compiler::Compiler comp(fileContent, std::filesystem::absolute(filePath), fileRecord, buildDir, relative.string(), options.target_triple);
 
     // Set up the synchronous dependency compiler callback
     comp.compile_dependency_cb = [&](const std::filesystem::path& depPath) {
-        compileSingleFile(depPath, srcDir, buildDir, optimizationLevel, verbose, rootFolder, "", emitLLVMOnly, target_triple);
+        compileSingleFile(depPath, srcDir, buildDir, options, rootFolder, astCache);
     };
+    comp.ast_cache = &astCache;
 
-    comp.compile(program);
-    delete program;
-
-    // Write LLVM IR to file
-    std::error_code EC;
-    llvm::raw_fd_ostream irFile(outputIRPath.string(), EC, llvm::sys::fs::OF_None);
-    if (EC) { errors::raiseCompilationError("Could not open IR file " + outputIRPath.string() + ": " + EC.message()); }
-    comp.llvm_module->print(irFile, nullptr);
-    irFile.close();
+    try {
+        comp.compile(program);
+    } catch (const std::exception& e) {
+        fileRecord->markFailed(e.what());
+        throw;
+    }
+    // Importers read the declarations from the interface instead of the source
+    compiler::writeInterface(program, comp.exported_names, compiler::interfacePath(buildDir, relative));
 
     // Mark as compiled
-    fileRecord->compiled = true;
+    fileRecord->markDone();
 
-    // Unless we are emitting LLVM IR only, compile to object file
-    if (!emitLLVMOnly) {
-        std::string optFlag = optimizationLevel.empty() ? "" : " -O" + optimizationLevel;
-        std::string clangCommand = "clang -c \"" + outputIRPath.string() + "\" -o \"" + objFilePath.string() + "\" -Woverride-module" + optFlag;
+    if (options.target_triples.size() > 1) {
+        // Records of the regenerated compilers; they own the environments, so they outlive them
+        std::vector<std::unique_ptr<compilationState::RecordFile>> records;
+        auto recompile = [&](const std::string& triple) {
+            auto& record = records.emplace_back(std::make_unique<compilationState::RecordFile>());
+            record->name = fileRecord->name;
+            record->folder = fileRecord->folder;
+            auto regenerated = std::make_unique<compiler::Compiler>(fileContent, std::filesystem::absolute(filePath), record.get(), buildDir, relative.string(), triple);
+            // Every import is compiled by now; only the code generation is repeated, never lexing or parsing
+            regenerated->ast_cache = &astCache;
+            regenerated->compile(program);
+            return regenerated;
+        };
+        emitForTargets(comp, recompile, options, outputPath, buildDir, relative);
+        if (verbose) { std::cout << "Successfully compiled: " << filePath << " for " << options.target_triples.size() << " targets" << std::endl; }
+        return;
+    }
 
-        int clangResult;
-        std::string clangOutput = runCommand(clangCommand, clangResult);
-        if (clangResult != 0) {
-            errors::raiseCompilationError("Failed to convert " + outputIRPath.string() + " to " + objFilePath.string() + "\nCommand: " + clangCommand + "\nOutput: " + clangOutput);
-        }
+    // Optimize in-process with the new pass manager
+    if (options.dumpOptIR) writeModuleIR(*comp.llvm_module, buildDir / "opt-ir" / (relative.string() + ".before.ll"));
+    comp.optimize(options.optimizationLevel, options.passPipeline);
+    if (options.dumpOptIR) writeModuleIR(*comp.llvm_module, buildDir / "opt-ir" / (relative.string() + ".after.ll"));
+
+    if (emitLLVMOnly) {
+        // Write LLVM IR to file
+        writeModuleIR(*comp.llvm_module, outputIRPath);
+    } else if (emitBCOnly) {
+        comp.emitBitcodeFile(outputBCPath);
+    } else {
+        // Lower the in-memory module straight to an object file
+        comp.emitObjectFile(objFilePath, options.optimizationLevel);
     }
 
     if (verbose) { std::cout << "Successfully compiled: " << filePath << std::endl; }
 }
 
+// Import graph of the input and every file it imports, directly or not; the input is node 0
+buildGraph::ImportGraph importGraphOf(const std::filesystem::path& inputFile, const std::filesystem::path& srcDir, compilationState::ASTCache& astCache) {
+    buildGraph::ImportGraph graph;
+    std::vector<size_t> queue = {graph.addFile(std::filesystem::relative(inputFile, srcDir))};
+    for (size_t head = 0; head < queue.size(); ++head) {
+        size_t idx = queue[head];
+        auto path = srcDir / graph[idx].relative;
+        // Missing imports are reported by the compiler itself
+        if (!std::filesystem::exists(path)) continue;
+        for (const auto& imported : buildGraph::collectImports(astCache.program(path), graph[idx].relative)) {
+            size_t count = graph.size();
+            size_t dep = graph.addFile(imported);
+            graph.addImport(idx, dep);
+            if (graph.size() > count) queue.push_back(dep);
+        }
+    }
+    return graph;
+}
+
+// Declare pass of the import cycles reachable from the input: writes the interface of every
+// file on a cycle, so the recursion of compileSingleFile stops at a file already being compiled
+void declareImportCycles(const buildGraph::ImportGraph& graph,
+                         const std::filesystem::path& srcDir,
+                         const std::filesystem::path& buildDir,
+                         const FrontendOptions& options,
+                         compilationState::RecordFolder* rootFolder,
+                         compilationState::ASTCache& astCache) {
+    for (const auto& cycle : graph.cycles()) {
+        std::cerr << "Warning: import cycle " << graph.describeCycle(cycle) << "; its files are declared first, so their declarations cannot use each other's types." << std::endl;
+        std::unordered_set<std::string> members;
+        for (size_t idx : cycle) members.insert(graph[idx].relative.generic_string());
+        for (size_t idx : cycle) {
+            const auto& relative = graph[idx].relative;
+            auto filePath = srcDir / relative;
+            timeTrace::Scope trace("Declare", relative.string());
+            compilationState::RecordFile* fileRecord = findOrCreateFileRecord(rootFolder, relative);
+            {
+                compiler::Compiler comp(astCache.source(filePath), std::filesystem::absolute(filePath), fileRecord, buildDir, relative.string(), options.target_triple);
+                // Imports from outside the cycle are compiled in full, as usual
+                comp.compile_dependency_cb = [&](const std::filesystem::path& depPath) {
+                    compileSingleFile(depPath, srcDir, buildDir, options, rootFolder, astCache);
+                };
+                comp.ast_cache = &astCache;
+                comp.declarations_only = true;
+                comp.deferred_imports = members;
+                auto program = astCache.program(filePath);
+                comp.compile(program);
+                compiler::writeInterface(program, comp.exported_names, compiler::interfacePath(buildDir, relative));
+            }
+            // The definitions are compiled into an environment of their own
+            delete fileRecord->env;
+            fileRecord->env = nullptr;
+            fileRecord->markDeclared();
+        }
+    }
+}
+
+// Writes a make-style depfile (-MD): the outputs depend on the input and every .gc file it imports
+void writeDepfile(const std::filesystem::path& depfile, const std::vector<std::filesystem::path>& targets, const std::filesystem::path& srcDir, const buildGraph::ImportGraph& graph) {
+    // Spaces & '#' are escaped for make and ninja alike, '$' the make way
+    auto escape = [](const std::string& path) {
+        std::string escaped;
+        for (char c : path) {
+            if (c == ' ' || c == '#') escaped += '\\';
+            else if (c == '$') escaped += '$';
+            escaped += c;
+        }
+        return escaped;
+    };
+    std::string text;
+    for (const auto& target : targets) text += escape(target.string()) + " ";
+    text.back() = ':';
+    for (size_t idx = 0; idx < graph.size(); ++idx) {
+        auto path = srcDir / graph[idx].relative;
+        if (std::filesystem::exists(path)) text += " \\\n  " + escape(path.string());
+    }
+
+    if (!depfile.parent_path().empty()) Utils::createDirectories(depfile.parent_path());
+    std::ofstream file(depfile, std::ios::trunc);
+    if (!(file << text << "\n")) errors::raiseCompilationError("Could not write depfile " + depfile.string());
+}
+
 int main(int argc, char* argv[]) {
     CLI::App app{"GigglyCode Single-File Compiler Frontend"};
 
     std::filesystem::path inputFile;
     std::filesystem::path outputFile;
-    std::string optimizationLevel = "";
-    std::string target_triple = "";
-    bool emitLLVM = false;
-    bool verbose = false;
+    FrontendOptions options;
 
     app.add_option("input_file", inputFile, "Input source file (.gc)")->required()->check(CLI::ExistingFile);
     app.add_option("-o,--output", outputFile, "Output file path");
-    app.add_option("-O,--optimization", optimizationLevel, "Optimization level (O1, O2, O3, Os, Ofast)")->default_val("");
-    app.add_flag("-S,--emit-llvm", emitLLVM, "Emit LLVM IR instead of object file");
-    app.add_flag("-v,--verbose", verbose, "Enable verbose output");
-    app.add_option("--target", target_triple, "Override target triple for cross-compilation (e.g. aarch64-unknown-linux-gnu). Default: host native.")->default_val("");
+    app.add_option("-O,--optimization", options.optimizationLevel, "Optimization level (0, 1, 2, 3, s, z, fast)")->default_val("");
+    app.add_option("--passes", options.passPipeline, "Custom LLVM pass pipeline used instead of the -O pipeline (e.g. \"function(mem2reg,instcombine)\")")->default_val("");
+    app.add_flag("--dump-opt-ir", options.dumpOptIR, "Write the IR before and after optimization to build/opt-ir");
+    app.add_flag("-S,--emit-llvm", options.emitLLVMOnly, "Emit textual LLVM IR instead of object file (for debugging)");
+    app.add_flag("--emit-bc", options.emitBCOnly, "Emit LLVM bitcode instead of object file");
+    app.add_flag("-v,--verbose", options.verbose, "Enable verbose output");
+    app.add_option("--target", options.target_triples, "Target triple(s) for cross-compilation (e.g. aarch64-unknown-linux-gnu), comma separated or repeated. With several, the file is parsed once and an output per target is written, the triple before its extension. Default: host native.")->delimiter(',');
+    app.add_flag("--time-trace", options.timeTrace, "Write a Chrome trace to build/time-trace.json and print the slowest files and functions");
+    app.add_option("--time-trace-top", options.timeTraceTop, "Number of files and functions listed in the --time-trace summary")->default_val(10);
+
+    app.add_flag("--MD", options.writeDepfile, "Write a depfile listing the input and every .gc file it imports, for make & ninja (also -MD)");
+    app.add_option("--MF", options.depfile, "Path of the depfile; implies --MD. Default: the output with a .d extension (also -MF)");
 
-    CLI11_PARSE(app, argc, argv);
+    // CLI11 only takes single-letter short options, so the C compilers' -MD & -MF[file] are respelled
+    std::vector<std::string> arguments(argv, argv + argc);
+    for (auto& argument : arguments) {
+        if (argument == "-MD" || argument == "-MF") argument = "-" + argument;
+        else if (argument.rfind("-MF", 0) == 0) argument = "--MF=" + argument.substr(3);
+    }
+    std::vector<char*> arguments_c;
+    for (auto& argument : arguments) arguments_c.push_back(argument.data());
+    CLI11_PARSE(app, static_cast<int>(arguments_c.size()), arguments_c.data());
+    if (options.timeTrace) timeTrace::enable();
+    if (!options.target_triples.empty()) options.target_triple = options.target_triples.front();
 
     // Resolve source directory and build directory relative to input file
     std::filesystem::path srcDir = inputFile.parent_path();
@@ -179,21 +400,43 @@ int main(int argc, char* argv[]) {
     // If output file is empty, default it
     if (outputFile.empty()) {
         outputFile = inputFile.stem();
-        if (emitLLVM) {
+        if (options.emitLLVMOnly) {
             outputFile += ".ll";
+        } else if (options.emitBCOnly) {
+            outputFile += ".bc";
         } else {
             outputFile += ".o";
         }
     }
 
     compilationState::RecordFolder rootFolder;
+    compilationState::ASTCache astCache;
 
     try {
-        compileSingleFile(inputFile, srcDir, buildDir, optimizationLevel, verbose, &rootFolder, outputFile, emitLLVM, target_triple);
+        auto graph = importGraphOf(inputFile, srcDir, astCache);
+        declareImportCycles(graph, srcDir, buildDir, options, &rootFolder, astCache);
+        compileSingleFile(inputFile, srcDir, buildDir, options, &rootFolder, astCache, outputFile);
+        if (options.writeDepfile || !options.depfile.empty()) {
+            std::filesystem::path depfile = options.depfile;
+            if (depfile.empty()) depfile = std::filesystem::path(outputFile).replace_extension(".d");
+            std::vector<std::filesystem::path> targets = {outputFile};
+            if (options.target_triples.size() > 1) {
+                targets.clear();
+                for (const auto& triple : options.target_triples) targets.push_back(targetOutputPath(outputFile, triple));
+            }
+            writeDepfile(depfile, targets, srcDir, graph);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Compilation failed: " << e.what() << std::endl;
         return 1;
     }
 
+    if (options.verbose) { std::cout << "AST cache: " << astCache.hits() << " hit(s), " << astCache.misses() << " miss(es)." << std::endl; }
+    if (options.timeTrace) {
+        std::filesystem::path tracePath = buildDir / "time-trace.json";
+        if (!timeTrace::writeChromeTrace(tracePath, "gigc")) std::cerr << "Warning: could not write time trace " << tracePath.string() << std::endl;
+        else std::cout << "Time trace written to " << tracePath.string() << std::endl;
+        timeTrace::printSummary(std::cout, options.timeTraceTop);
+    }
     return 0;
 }
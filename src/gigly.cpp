@@ -1,28 +1,53 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Program.h>
+#include <llvm/TargetParser/Host.h>
 #include <memory>
 #include <mutex>
 #include <queue>
 #include <sstream>
 #include <system_error>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Include necessary headers
+#include "build_graph.hpp"
+#include "build_manifest.hpp"
 #include "compilation_state.hpp"
+#include "compile_server.hpp"
+#include "compiler/codegen.hpp"
 #include "compiler/compiler.hpp"
+#include "compiler/interface.hpp"
 #include "errors/errors.hpp"
 #include "include/cli11.hpp"
+#include "jit.hpp"
 #include "lexer/lexer.hpp"
+#include "linker.hpp"
+#include "lto.hpp"
+#include "object_cache.hpp"
 #include "parser/parser.hpp"
+#include "repl.hpp"
+#include "thread_pool.hpp"
+#include "time_trace.hpp"
+#include "watch.hpp"
 
 #define DEBUG_LEXER
 #define DEBUG_PARSER
@@ -57,24 +82,73 @@ class EnvManager {
     }
 };
 
+// =======================================
+// Build Options
+// =======================================
+struct BuildOptions {
+    std::string optimizationLevel;                                      // "" = leave the IR as generated
+    std::unordered_map<std::string, std::string> fileOptimizationLevels; // per-file -O, keyed by path relative to src/
+    std::string passPipeline;                                           // custom pass pipeline, replaces the -O pipeline
+    bool dumpOptIR = false;                                             // write IR before & after optimization to build/opt-ir
+    bool verbose = false;
+    std::string target_triple; // empty = native
+    unsigned jobs = 0;         // 0 = one worker per core
+    bool emitLLVM = false;     // also write textual IR to build/ir (debugging aid)
+    bool emitBC = false;       // also write LLVM bitcode to build/bc
+    bool gcSections = false;   // drop unreferenced sections at link time
+    unsigned linkThreads = 0;  // 0 = same as jobs
+    std::string lto;           // "", "full" or "thin": .gc files become bitcode optimized together at link time
+    bool unity = false;        // compile every .gc file into one shared module
+    bool timeTrace = false;    // write a Chrome trace of the build to build/time-trace.json
+    size_t timeTraceTop = 10;  // files & functions listed in the time trace summary
+    bool watch = false;        // rebuild whenever src/ changes
+    std::string watchRun;      // command run after every successful --watch build
+    bool cache = false;        // share compiled .gc files through the object cache
+    std::string cacheDir;      // "" = $XDG_CACHE_HOME/gigly
+    size_t cacheLimit = 5120;  // MiB the object cache is trimmed to
+    bool jit = false;          // gigly run: modules are kept in memory for the JIT, no objects are written
+};
+
 class Compiler {
   public:
-    Compiler(const std::filesystem::path& srcDir, const std::filesystem::path& buildDir, const std::string& optimizationLevel, bool verbose, const std::string& target_triple = "")
-        : srcDir(srcDir), buildDir(buildDir), optimizationLevel(optimizationLevel), verbose(verbose), target_triple(target_triple), irDir(buildDir / "ir"), objDir(buildDir / "obj") {
-        Utils::createDirectories(irDir);
+    Compiler(const std::filesystem::path& srcDir, const std::filesystem::path& buildDir, const BuildOptions& options, compilationState::ASTCache& astCache)
+        : srcDir(srcDir), buildDir(buildDir), options(options), irDir(buildDir / "ir"), optIRDir(buildDir / "opt-ir"), objDir(buildDir / "obj"), bcDir(buildDir / "bc"),
+          ltoMode(compiler::parseLTOMode(options.lto).value_or(compiler::LTOMode::None)), astCache(astCache) {
+        if (options.emitLLVM) Utils::createDirectories(irDir);
+        if (options.dumpOptIR) Utils::createDirectories(optIRDir);
         Utils::createDirectories(objDir);
+        if (options.emitBC || ltoMode != compiler::LTOMode::None) Utils::createDirectories(bcDir);
+        if (options.cache) {
+            auto cacheDir = options.cacheDir.empty() ? compilationState::ObjectCache::defaultDirectory() : std::filesystem::path(options.cacheDir);
+            objectCache = std::make_unique<compilationState::ObjectCache>(cacheDir, options.cacheLimit * 1024 * 1024);
+        }
 
-        if (verbose) {
+        if (options.verbose) {
             std::cout << "Compiler initialized with:\n"
                       << " Source Directory: " << srcDir << "\n"
                       << " Build Directory: " << buildDir << "\n"
-                      << " Optimization Level: " << (optimizationLevel.empty() ? "None" : optimizationLevel) << "\n";
+                      << " Optimization Level: " << (options.optimizationLevel.empty() ? "None" : options.optimizationLevel) << "\n";
+            if (!options.passPipeline.empty()) std::cout << " Pass Pipeline: " << options.passPipeline << "\n";
+            if (!options.lto.empty()) std::cout << " LTO: " << options.lto << "\n";
+            if (options.unity) std::cout << " Unity build: every .gc file is compiled into one module\n";
+            if (objectCache) std::cout << " Object cache: " << objectCache->root() << "\n";
+            for (const auto& [file, level] : options.fileOptimizationLevels) { std::cout << " Optimization Level for " << file << ": " << level << "\n"; }
         }
     }
 
     /**
      * @brief Compiles all supported files in the source directory.
      *
+     * Every file is hashed and checked against the build manifest. Files whose
+     * source, settings and imports are unchanged are neither parsed nor
+     * compiled. The rest are parsed once to build the import graph, then
+     * compiled on a fixed-size pool in dependency order, so a file only starts
+     * once everything it imports is compiled.
+     *
+     * With --unity every .gc file is compiled, one at a time, into a shared
+     * LLVMContext and merged into a single module, which is then optimized and
+     * lowered once.
+     *
      * @param rootFolder The root folder to track compiled files.
      */
     void compileAll(compilationState::RecordFolder* rootFolder) {
@@ -84,171 +158,674 @@ class Compiler {
             if (entry.is_regular_file() && isSupportedFile(entry.path())) { files.emplace_back(entry.path()); }
         }
 
-        if (verbose) { std::cout << "Found " << files.size() << " file(s) to compile." << std::endl; }
+        if (options.verbose) { std::cout << "Found " << files.size() << " file(s) to compile." << std::endl; }
+
+        buildGraph::ThreadPool pool(options.jobs);
+        if (options.verbose) { std::cout << "Starting compilation with " << pool.size() << " worker(s)..." << std::endl; }
+
+        // Nothing from an earlier build is reused when running in the JIT
+        if (!options.jit) manifest.load(manifestPath());
+        std::vector<std::string> relatives(files.size());
+        for (size_t idx = 0; idx < files.size(); ++idx) { relatives[idx] = std::filesystem::relative(files[idx], srcDir).lexically_normal().string(); }
+
+        // Read & hash every file; only .gc files that changed are parsed here,
+        // the imports of unchanged ones come from the manifest
+        std::vector<ParsedFile> parsed(files.size());
+        for (size_t idx = 0; idx < files.size(); ++idx) {
+            pool.submit([this, &files, &relatives, &parsed, idx]() {
+                parsed[idx].source = &astCache.source(files[idx]);
+                parsed[idx].source_hash = Utils::computeHash(*parsed[idx].source);
+                auto previous = manifest.find(relatives[idx]);
+                if (!previous || previous->source_hash != parsed[idx].source_hash) parseFile(files[idx], parsed[idx]);
+            });
+        }
+        pool.wait();
+
+        // Build the import graph from the ImportStatements
+        buildGraph::ImportGraph graph;
+        for (const auto& relative : relatives) { graph.addFile(relative); }
+        for (size_t idx = 0; idx < files.size(); ++idx) {
+            std::vector<std::filesystem::path> imports;
+            if (parsed[idx].program) {
+                imports = buildGraph::collectImports(parsed[idx].program, graph[idx].relative);
+            } else if (auto previous = manifest.find(relatives[idx])) {
+                imports.assign(previous->imports.begin(), previous->imports.end());
+            }
+            for (const auto& imported : imports) {
+                parsed[idx].imports.push_back(imported.string());
+                // Imports that are not part of this project are reported by the compiler itself
+                if (auto dep = graph.find(imported)) { graph.addImport(idx, *dep); }
+            }
+        }
 
-        // Spawning one thread per file to avoid thread starvation deadlocks when waiting on imports
-        if (verbose) { std::cout << "Starting compilation with " << files.size() << " thread(s)..." << std::endl; }
+        // The files of an import cycle are declared together before any of them compiles.
+        // Their imports inside the cycle are not in the manifest, so they are always rebuilt
+        auto cycles = graph.cycles();
+        std::vector<size_t> cycleOf(files.size(), SIZE_MAX);
+        for (size_t cycle = 0; cycle < cycles.size(); ++cycle) {
+            std::cerr << "Warning: import cycle " << graph.describeCycle(cycles[cycle]) << "; its files are declared first, so their declarations cannot use each other's types." << std::endl;
+            for (size_t idx : cycles[cycle]) cycleOf[idx] = cycle;
+        }
+        graph.collapseCycles(cycles);
+        graph.computePriorities();
+        auto declared = std::make_unique<std::once_flag[]>(cycles.size());
+
+        // Exactly the objects of this build are linked, never leftovers in build/obj
+        objectFiles.clear();
+        bool hasUnityFiles = false;
+        for (size_t idx = 0; idx < files.size(); ++idx) {
+            if (isUnityFile(files[idx])) hasUnityFiles = true;
+            else objectFiles.push_back(objectPathFor(graph[idx].relative));
+        }
+        if (hasUnityFiles) {
+            startUnity();
+            objectFiles.push_back(unityObjectPath());
+        }
 
-        std::vector<std::thread> workers;
-        for (const auto& file : files) {
-            workers.emplace_back([this, file, rootFolder]() {
-                compileFile(file, rootFolder);
-            });
+        // A file is checked once its imports are done: it depends on their
+        // interface hashes, so a body-only edit of an import keeps it up to date
+        std::vector<uint64_t> interfaceHashes(files.size(), 0);
+        std::atomic<size_t> rebuildCount = 0;
+        buildGraph::BuildScheduler scheduler(graph, pool);
+        auto unscheduled = scheduler.run([&, rootFolder](size_t idx) {
+            auto& file = parsed[idx];
+            bool onCycle = cycleOf[idx] != SIZE_MAX;
+            if (onCycle) std::call_once(declared[cycleOf[idx]], [&]() { declareCycle(cycles[cycleOf[idx]], files, parsed, rootFolder); });
+            file.entry = manifestEntryFor(idx, graph, parsed, relatives, interfaceHashes);
+            auto previous = manifest.find(relatives[idx]);
+            // The unity module is rebuilt as a whole
+            if (!onCycle && !isUnityFile(files[idx]) && isUpToDate(files[idx], file.entry, previous)) {
+                file.entry.interface_hash = previous->interface_hash;
+                file.entry.object_stamp = previous->object_stamp;
+                interfaceHashes[idx] = previous->interface_hash;
+                // Importers read the interface file, so the record is done without compiling
+                auto fileRecord = findOrCreateFileRecord(rootFolder, relatives[idx]);
+                if (fileRecord->tryStart()) fileRecord->markDone();
+                return;
+            }
+            rebuildCount++;
+            if (onCycle || !restoreFromCache(files[idx], relatives[idx], file, rootFolder)) {
+                if (!file.program) parseFile(files[idx], file);
+                compileFile(files[idx], file, rootFolder);
+                if (!onCycle) storeInCache(files[idx], relatives[idx], file);
+            }
+            interfaceHashes[idx] = file.entry.interface_hash;
+            if (!isUnityFile(files[idx])) file.entry.object_stamp = objectStamp(objectPathFor(relatives[idx]));
+        });
+
+        if (!unscheduled.empty()) {
+            std::string cycle;
+            for (size_t idx : unscheduled) { cycle += "\n  " + graph[idx].relative.string(); }
+            errors::raiseCompilationError("Import cycle detected, the following files could not be compiled:" + cycle, "Remove the circular import between these files.");
         }
 
-        for (auto& worker : workers) {
-            if (worker.joinable()) { worker.join(); }
+        if (hasUnityFiles) finishUnity();
+        if (objectCache && objectCache->misses() > 0) objectCache->evict();
+
+        // Record what was built; entries of deleted files are dropped. Files
+        // of a unity build have no object of their own, so they get none
+        compilationState::BuildManifest updated;
+        updated.link_hash = manifest.link_hash;
+        for (size_t idx = 0; idx < files.size(); ++idx) {
+            if (!isUnityFile(files[idx])) updated.set(relatives[idx], std::move(parsed[idx].entry));
         }
+        manifest = std::move(updated);
+        if (!options.jit) manifest.save(manifestPath());
+        rebuiltFiles = rebuildCount;
+
+        if (options.verbose) {
+            std::cout << "Compilation phase completed, " << rebuiltFiles << " of " << files.size() << " file(s) rebuilt." << std::endl;
+            std::cout << "AST cache: " << astCache.hits() << " hit(s), " << astCache.misses() << " miss(es)." << std::endl;
+            if (objectCache) std::cout << "Object cache: " << objectCache->hits() << " hit(s), " << objectCache->misses() << " miss(es)." << std::endl;
+            std::cout << "Target machines created: " << compiler::TargetRegistry::instance().created() << std::endl;
+        }
+    }
 
-        if (verbose) { std::cout << "Compilation phase completed." << std::endl; }
+    /**
+     * @brief Runs the modules compiled by compileAll in the JIT (`gigly run`).
+     *
+     * @param programName argv[0] of the program.
+     * @param args The arguments after it.
+     * @param tierThreshold Calls + loop iterations before a function is re-optimized; 0 runs lazily instead of tiered.
+     * @param reload Set to hot-reload the program with the modules it returns.
+     * @return int The exit status of the program, or 1 if it could not be started.
+     */
+    int runJIT(const std::string& programName, const std::vector<std::string>& args, unsigned tierThreshold, jit::ReloadFn reload = nullptr) {
+        jit::RunOptions run;
+        run.modules = std::move(jitModules);
+        run.bitcode = std::move(jitBitcode);
+        run.programName = programName;
+        run.args = args;
+        run.tierThreshold = tierThreshold;
+        run.reload = std::move(reload);
+        run.verbose = options.verbose;
+
+        if (options.verbose) std::cout << "Running " << run.modules.size() + run.bitcode.size() << " module(s) in the JIT..." << std::endl;
+        int exitCode = 0;
+        std::string diagnostics;
+        if (!jit::run(run, exitCode, diagnostics)) {
+            std::cerr << "Error: could not run the program in the JIT:\n" << diagnostics;
+            return 1;
+        }
+        return exitCode;
     }
 
     /**
-     * @brief Links all object files into the final executable.
+     * @brief Hands over the .gc modules compiled by compileAll (`gigly run --hot-reload`).
+     */
+    std::vector<jit::JITModule> takeJITModules() { return std::move(jitModules); }
+
+    /**
+     * @brief Links the object files of this build into the final executable.
+     *
+     * Uses the embedded lld when gigly was built with it, `clang++` otherwise.
      *
      * @param executablePath The path to the output executable.
      * @return int Exit status code.
-     * @throws CompilationException If linking fails.
      */
-    int linkAll(const std::filesystem::path& executablePath) const {
-        std::string objFiles;
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(objDir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".o") { objFiles += "\"" + entry.path().string() + "\" "; }
-        }
-
-        if (objFiles.empty()) {
+    int linkAll(const std::filesystem::path& executablePath) {
+        if (objectFiles.empty()) {
             std::cerr << "Error: No object files found to link." << std::endl;
             return 1;
         }
 
-        std::string linkCommand = "clang++ " + objFiles + "-o \"" + executablePath.string() + "\"";
-        if (verbose) {
-            std::cout << "Linking object files into executable..." << std::endl;
-            std::cout << "Link Command: " << linkCommand << std::endl;
+        // Nothing was rebuilt and the link inputs are the same: keep the executable
+        std::string linkInputs = executablePath.string() + "\n" + options.target_triple + "\n" + (options.gcSections ? "gc-sections" : "");
+        // The link step optimizes with LTO, so the optimization settings are link inputs too
+        if (ltoMode != compiler::LTOMode::None) linkInputs += "\nlto=" + options.lto + " -O" + options.optimizationLevel + " " + options.passPipeline;
+        for (const auto& object : objectFiles) linkInputs += "\n" + object.string();
+        uint64_t linkHash = Utils::computeHash(linkInputs);
+        if (rebuiltFiles == 0 && manifest.link_hash == linkHash && std::filesystem::exists(executablePath)) {
+            if (options.verbose) { std::cout << "Executable is up to date: " << executablePath << std::endl; }
+            return 0;
+        }
+
+        std::vector<std::filesystem::path> linkObjects = objectFiles;
+        if (ltoMode != compiler::LTOMode::None) linkObjects = linkTimeOptimize();
+
+        linker::LinkOptions linkOptions;
+        linkOptions.objects = linkObjects;
+        linkOptions.output = executablePath;
+        linkOptions.buildDir = buildDir;
+        linkOptions.target_triple = options.target_triple;
+        linkOptions.gcSections = options.gcSections;
+        linkOptions.threads = options.linkThreads != 0 ? options.linkThreads : options.jobs;
+        linkOptions.verbose = options.verbose;
+
+        if (options.verbose) {
+            std::cout << "Linking " << linkObjects.size() << " object file(s) into executable" << (linker::hasEmbeddedLinker() ? " with the embedded lld" : "") << "..." << std::endl;
         }
 
-        int exit_code;
-        std::string linkOutput = runCommand(linkCommand, exit_code);
-        if (exit_code != 0) { errors::raiseCompilationError("Failed to link object files into executable " + executablePath.string() + "\nCommand: " + linkCommand + "\nOutput: " + linkOutput); }
+        std::string linkOutput;
+        timeTrace::Scope trace("Link", executablePath.string());
+        if (!linker::link(linkOptions, linkOutput)) { errors::raiseCompilationError("Failed to link object files into executable " + executablePath.string() + "\nOutput: " + linkOutput); }
 
-        if (verbose) { std::cout << "Successfully linked object files into executable: " << executablePath << std::endl; }
+        manifest.link_hash = linkHash;
+        manifest.save(manifestPath());
+
+        if (options.verbose) { std::cout << "Successfully linked object files into executable: " << executablePath << std::endl; }
         return 0;
     }
 
+    /**
+     * @brief Checks if a file has a supported extension.
+     *
+     * @param path The path to the file.
+     * @return true If the file is supported.
+     * @return false Otherwise.
+     */
+    static bool isSupportedFile(const std::filesystem::path& path) {
+        static const std::vector<std::filesystem::path> supportedExtensions = {".gc", ".c", ".rs"};
+        return std::find(supportedExtensions.begin(), supportedExtensions.end(), path.extension()) != supportedExtensions.end();
+    }
+
   private:
     std::filesystem::path srcDir;
     std::filesystem::path buildDir;
-    std::string optimizationLevel;
-    bool verbose;
-    std::string target_triple; // empty = native
+    BuildOptions options;
 
     std::filesystem::path irDir;
+    std::filesystem::path optIRDir;
     std::filesystem::path objDir;
+    std::filesystem::path bcDir; // Bitcode: --emit-bc output, --lto input and the Rust intermediate
+    compiler::LTOMode ltoMode;
+
+    // --unity: every .gc module is merged into unityModule, one file at a time
+    std::unique_ptr<llvm::LLVMContext> unityContext;
+    std::unique_ptr<llvm::Module> unityModule;
+    std::mutex unityMutex; // The shared context is not thread-safe
+
+    std::vector<std::filesystem::path> objectFiles; // Objects produced by compileAll, in source order
+
+    compilationState::ASTCache& astCache;     // Sources & programs shared by the workers; outlives the run under --serve
+    compilationState::BuildManifest manifest; // What the previous build produced
+    std::unique_ptr<compilationState::ObjectCache> objectCache; // Set with --cache
+    size_t rebuiltFiles = 0;                  // Files compiled by the last compileAll
 
     std::mutex recordMutex; // Mutex to protect compiledFilesRecord
 
+    // gigly run: what compileAll produced for the JIT instead of objects
+    std::vector<jit::JITModule> jitModules;
+    std::vector<std::filesystem::path> jitBitcode; // C & Rust files
+    std::mutex jitMutex;
+
     /**
-     * @brief Checks if a file has a supported extension.
+     * @brief Source and AST of a file, produced once before scheduling.
+     */
+    struct ParsedFile {
+        const std::string* source = nullptr; ///< Owned by astCache
+        uint64_t source_hash = 0;
+        AST::Program* program = nullptr;  ///< Owned by astCache; only set for .gc files that are compiled
+        std::vector<std::string> imports; ///< Direct imports, relative to the source directory
+        compilationState::ManifestEntry entry;
+    };
+
+    std::filesystem::path manifestPath() const { return buildDir / "manifest.yaml"; }
+
+    /**
+     * @brief Modification time of an object, or 0 if it does not exist.
+     */
+    static int64_t objectStamp(const std::filesystem::path& path) {
+        std::error_code ec;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        return ec ? 0 : static_cast<int64_t>(mtime.time_since_epoch().count());
+    }
+
+    /**
+     * @brief Whether the outputs recorded for a file can be reused.
      *
-     * @param path The path to the file.
-     * @return true If the file is supported.
-     * @return false Otherwise.
+     * Besides matching inputs, the object must be the one the manifest saw
+     * (an interrupted build may have rewritten it) and the interface must
+     * still be there for importers.
      */
-    bool isSupportedFile(const std::filesystem::path& path) const {
-        static const std::vector<std::filesystem::path> supportedExtensions = {".gc", ".c", ".rs"};
-        return std::find(supportedExtensions.begin(), supportedExtensions.end(), path.extension()) != supportedExtensions.end();
+    bool isUpToDate(const std::filesystem::path& filePath, const compilationState::ManifestEntry& current, const compilationState::ManifestEntry* previous) const {
+        if (!previous || !previous->sameInputs(current) || options.dumpOptIR) return false;
+        auto relative = std::filesystem::relative(filePath, srcDir);
+        if (previous->object_stamp == 0 || objectStamp(objectPathFor(relative)) != previous->object_stamp) return false;
+        if (filePath.extension() == ".gc" && compiler::readInterfaceHash(compiler::interfacePath(buildDir, relative)) != previous->interface_hash) return false;
+        if (options.emitLLVM && !std::filesystem::exists(irDir / (relative.string() + ".ll"))) return false;
+        if (options.emitBC && !std::filesystem::exists(bitcodePathFor(relative))) return false;
+        return true;
+    }
+
+    /**
+     * @brief Whether the outputs of a file may come from the object cache.
+     *
+     * Only .gc files qualify: C and Rust files are built by external tools
+     * whose inputs (headers, crates) the manifest does not track. Unity files
+     * share one object and --dump-opt-ir needs the optimizer to actually run.
+     */
+    bool isCacheable(const std::filesystem::path& filePath) const {
+        return objectCache && filePath.extension() == ".gc" && !isUnityFile(filePath) && !options.dumpOptIR && !options.jit;
+    }
+
+    /**
+     * @brief The build directory paths of a file's cached outputs.
+     */
+    compilationState::CacheArtifacts cacheArtifactsFor(const std::filesystem::path& relative) const {
+        compilationState::CacheArtifacts artifacts;
+        artifacts.object = objectPathFor(relative);
+        artifacts.interface = compiler::interfacePath(buildDir, relative);
+        // Under --lto the object already is the bitcode
+        if (options.emitBC && ltoMode == compiler::LTOMode::None) artifacts.bitcode = bitcodePathFor(relative);
+        if (options.emitLLVM) artifacts.ir = irDir / (relative.string() + ".ll");
+        return artifacts;
+    }
+
+    /**
+     * @brief Copies a file's outputs out of the object cache instead of compiling it.
+     * @return Whether the file is done.
+     */
+    bool restoreFromCache(const std::filesystem::path& filePath, const std::string& relative, ParsedFile& parsed, compilationState::RecordFolder* rootFolder) {
+        if (!isCacheable(filePath)) return false;
+        auto artifacts = cacheArtifactsFor(relative);
+        if (!objectCache->fetch(compilationState::ObjectCache::key(relative, parsed.entry), artifacts)) return false;
+        auto interfaceHash = compiler::readInterfaceHash(artifacts.interface);
+        if (!interfaceHash) return false;
+
+        if (options.verbose) std::cout << "Restored from object cache: " << filePath << std::endl;
+        parsed.entry.interface_hash = *interfaceHash;
+        auto fileRecord = findOrCreateFileRecord(rootFolder, relative);
+        if (fileRecord->tryStart()) fileRecord->markDone();
+        return true;
+    }
+
+    /**
+     * @brief Adds the outputs of a freshly compiled file to the object cache.
+     */
+    void storeInCache(const std::filesystem::path& filePath, const std::string& relative, const ParsedFile& parsed) {
+        if (!isCacheable(filePath)) return;
+        objectCache->store(compilationState::ObjectCache::key(relative, parsed.entry), cacheArtifactsFor(relative));
+    }
+
+    /**
+     * @brief Lexes and parses a .gc file whose source has been read.
+     */
+    void parseFile(const std::filesystem::path& filePath, ParsedFile& parsed) {
+        if (filePath.extension() != ".gc") return;
+        parsed.program = astCache.program(filePath);
+    }
+
+    /**
+     * @brief Declare pass of an import cycle: writes the interface of every file on it before any of them compiles.
+     *
+     * Each file is compiled without function bodies and without its imports
+     * from the cycle, which is all its interface needs. The files are then
+     * compiled as usual and read each other's declarations from there.
+     *
+     * @param cycle Nodes of the files on the cycle; everything they import from outside it is done.
+     */
+    void declareCycle(const std::vector<size_t>& cycle, const std::vector<std::filesystem::path>& files, std::vector<ParsedFile>& parsed, compilationState::RecordFolder* rootFolder) {
+        std::unordered_set<std::string> members;
+        for (size_t idx : cycle) members.insert(std::filesystem::relative(files[idx], srcDir).lexically_normal().generic_string());
+        for (size_t idx : cycle) {
+            if (files[idx].extension() != ".gc") continue;
+            auto relative = std::filesystem::relative(files[idx], srcDir);
+            timeTrace::Scope trace("Declare", relative.string());
+            if (!parsed[idx].program) parseFile(files[idx], parsed[idx]);
+            auto fileRecord = findOrCreateFileRecord(rootFolder, relative);
+            {
+                compiler::Compiler comp(*parsed[idx].source, std::filesystem::absolute(files[idx]), fileRecord, buildDir, relative.string(), options.target_triple);
+                comp.ast_cache = &astCache;
+                comp.declarations_only = true;
+                comp.deferred_imports = members;
+                comp.compile(parsed[idx].program);
+                compiler::writeInterface(parsed[idx].program, comp.exported_names, compiler::interfacePath(buildDir, relative));
+            }
+            // The definitions are compiled into an environment of their own
+            delete fileRecord->env;
+            fileRecord->env = nullptr;
+            fileRecord->markDeclared();
+            if (options.verbose) std::cout << "Declared file of an import cycle: " << files[idx] << std::endl;
+        }
+    }
+
+    /**
+     * @brief Builds the manifest entry describing the current inputs of a file.
+     *
+     * @param idx Node of the file in the import graph.
+     * @param interfaceHashes Interface hashes of the files compiled so far; all imports of `idx` are done.
+     */
+    compilationState::ManifestEntry manifestEntryFor(size_t idx,
+                                                     const buildGraph::ImportGraph& graph,
+                                                     const std::vector<ParsedFile>& parsed,
+                                                     const std::vector<std::string>& relatives,
+                                                     const std::vector<uint64_t>& interfaceHashes) const {
+        compilationState::ManifestEntry entry;
+        entry.source_hash = parsed[idx].source_hash;
+        entry.compiler_id = compilationState::BuildManifest::compilerId();
+        entry.target_triple = options.target_triple.empty() ? llvm::sys::getDefaultTargetTriple() : options.target_triple;
+        entry.optimization_level = optimizationLevelFor(relatives[idx]);
+        entry.pass_pipeline = options.passPipeline;
+        entry.lto = options.lto;
+        entry.imports = parsed[idx].imports;
+
+        // Interfaces of every file reachable through imports, in a stable order
+        std::vector<bool> seen(graph.size(), false);
+        std::vector<size_t> stack(graph[idx].imports.begin(), graph[idx].imports.end());
+        std::vector<size_t> reachable;
+        while (!stack.empty()) {
+            size_t dep = stack.back();
+            stack.pop_back();
+            if (seen[dep]) continue;
+            seen[dep] = true;
+            reachable.push_back(dep);
+            stack.insert(stack.end(), graph[dep].imports.begin(), graph[dep].imports.end());
+        }
+        std::sort(reachable.begin(), reachable.end(), [&relatives](size_t a, size_t b) { return relatives[a] < relatives[b]; });
+        std::string importsKey;
+        for (size_t dep : reachable) importsKey += relatives[dep] + ":" + std::to_string(interfaceHashes[dep]) + "\n";
+        // Imports missing from the project still have to invalidate the file
+        for (const auto& imported : parsed[idx].imports) {
+            if (!graph.find(imported)) importsKey += imported + ":missing\n";
+        }
+        entry.imports_hash = Utils::computeHash(importsKey);
+        return entry;
+    }
+
+    /**
+     * @brief Optimizes the bitcode of every .gc file as one program.
+     *
+     * @return The objects to link: the LTO output followed by the native objects of C/Rust files.
+     */
+    std::vector<std::filesystem::path> linkTimeOptimize() {
+        timeTrace::Scope trace("LTO", options.lto);
+        linker::LTOOptions ltoOptions;
+        for (const auto& object : objectFiles) {
+            if (object.extension() == ".bc") ltoOptions.bitcode.push_back(object);
+            else ltoOptions.nativeObjects.push_back(object);
+        }
+        ltoOptions.outputDir = buildDir / "lto";
+        ltoOptions.target_triple = options.target_triple;
+        ltoOptions.optimizationLevel = options.optimizationLevel;
+        ltoOptions.passPipeline = options.passPipeline;
+        ltoOptions.mode = ltoMode;
+        ltoOptions.threads = options.jobs;
+
+        if (options.verbose) { std::cout << "Running " << options.lto << " LTO over " << ltoOptions.bitcode.size() << " module(s)..." << std::endl; }
+
+        std::vector<std::filesystem::path> objects;
+        std::string ltoOutput;
+        if (!linker::linkTimeOptimize(ltoOptions, objects, ltoOutput)) { errors::raiseCompilationError("Link time optimization failed\nOutput: " + ltoOutput); }
+        objects.insert(objects.end(), ltoOptions.nativeObjects.begin(), ltoOptions.nativeObjects.end());
+        return objects;
+    }
+
+    /**
+     * @brief Whether a file is compiled into the unity module.
+     */
+    bool isUnityFile(const std::filesystem::path& filePath) const { return options.unity && filePath.extension() == ".gc"; }
+
+    std::filesystem::path unityObjectPath() const { return objDir / "unity.o"; }
+
+    /**
+     * @brief Creates the shared context and the empty module the .gc files are merged into.
+     */
+    void startUnity() {
+        unityContext = std::make_unique<llvm::LLVMContext>();
+        unityModule = std::make_unique<llvm::Module>("unity", *unityContext);
+        unityModule->setTargetTriple(options.target_triple.empty() ? llvm::sys::getDefaultTargetTriple() : options.target_triple);
+        if (auto layout = compiler::TargetRegistry::instance().dataLayout(compiler::TargetKey{options.target_triple})) unityModule->setDataLayout(*layout);
+    }
+
+    /**
+     * @brief Optimizes the unity module as a whole and lowers it to unityObjectPath().
+     *
+     * Per-file optimization levels do not apply: there is a single module.
+     */
+    void finishUnity() {
+        compiler::verifyModule(*unityModule, "the unity module");
+        auto unityTarget = compiler::acquireTargetMachine(options.target_triple);
+
+        if (options.dumpOptIR) writeModuleIR(*unityModule, optIRDir / "unity.before.ll");
+        compiler::optimizeModule(*unityModule, unityTarget.get(), options.optimizationLevel, options.passPipeline);
+        if (options.dumpOptIR) writeModuleIR(*unityModule, optIRDir / "unity.after.ll");
+
+        if (options.emitLLVM) writeModuleIR(*unityModule, irDir / "unity.ll");
+        if (options.emitBC) compiler::emitBitcodeFile(*unityModule, bcDir / "unity.bc");
+        compiler::emitObjectFile(*unityModule, unityTarget.get(), unityObjectPath(), options.optimizationLevel);
+
+        if (options.verbose) { std::cout << "Compiled unity module: " << unityObjectPath() << std::endl; }
+        unityModule.reset();
+        unityContext.reset();
+    }
+
+    /**
+     * @brief Returns the object file of a source file; with --lto, the bitcode of a .gc file.
+     *
+     * @param relative Path of the file relative to the source directory.
+     */
+    std::filesystem::path objectPathFor(const std::filesystem::path& relative) const {
+        if (ltoMode != compiler::LTOMode::None && relative.extension() == ".gc") return bitcodePathFor(relative);
+        return objDir / (relative.string() + ".o");
+    }
+
+    /**
+     * @brief Returns the bitcode file of a source file.
+     *
+     * @param relative Path of the file relative to the source directory.
+     */
+    std::filesystem::path bitcodePathFor(const std::filesystem::path& relative) const { return bcDir / (relative.string() + ".bc"); }
+
+    /**
+     * @brief Returns the optimization level of a file, honouring per-file overrides.
+     *
+     * @param relative Path of the file relative to the source directory.
+     */
+    const std::string& optimizationLevelFor(const std::filesystem::path& relative) const {
+        auto it = options.fileOptimizationLevels.find(relative.lexically_normal().string());
+        return it == options.fileOptimizationLevels.end() ? options.optimizationLevel : it->second;
+    }
+
+    /**
+     * @brief Writes the textual IR of a module.
+     *
+     * @param module The module to print.
+     * @param path The path of the .ll file.
+     */
+    void writeModuleIR(const llvm::Module& module, const std::filesystem::path& path) const {
+        timeTrace::Scope trace("Print IR", path.string());
+        Utils::createDirectories(path.parent_path());
+        std::error_code EC;
+        llvm::raw_fd_ostream irFile(path.string(), EC, llvm::sys::fs::OF_None);
+        if (EC) { errors::raiseCompilationError("Could not open IR file " + path.string() + ": " + EC.message()); }
+        module.print(irFile, nullptr);
     }
 
     /**
      * @brief Compiles an individual file depending on its extension.
      *
      * @param filePath The path to the source file.
+     * @param parsed The source & AST read for the file before scheduling.
      * @param rootFolder The root folder to track compiled files.
      */
-    void compileFile(const std::filesystem::path& filePath, compilationState::RecordFolder* rootFolder) {
+    void compileFile(const std::filesystem::path& filePath, ParsedFile& parsed, compilationState::RecordFolder* rootFolder) {
         auto relative = std::filesystem::relative(filePath, srcDir);
+        timeTrace::Scope trace(timeTrace::COMPILE_FILE, relative.string());
         std::filesystem::path outputIRPath = irDir / (relative.string() + ".ll");
-        std::filesystem::path objFilePath = objDir / (relative.string() + ".o");
+        std::filesystem::path objFilePath = objectPathFor(relative);
 
-        if (verbose) {
-            std::cout << "Compiling file: " << filePath << "\n"
-                      << " Output IR Path: " << outputIRPath << "\n"
-                      << " Object File Path: " << objFilePath << "\n";
+        if (options.verbose) {
+            std::cout << "Compiling file: " << filePath << "\n";
+            if (options.emitLLVM) std::cout << " Output IR Path: " << outputIRPath << "\n";
+            if (options.emitBC) std::cout << " Output Bitcode Path: " << bitcodePathFor(relative) << "\n";
+            std::cout << " Object File Path: " << objFilePath << "\n";
         }
 
-        Utils::createDirectories(outputIRPath.parent_path());
-
-        std::string fileContent = Utils::readFileToString(filePath);
+        if (options.emitLLVM) Utils::createDirectories(outputIRPath.parent_path());
+        if (options.emitBC || options.jit || filePath.extension() == ".rs") Utils::createDirectories(bitcodePathFor(relative).parent_path());
+        Utils::createDirectories(objFilePath.parent_path());
 
         // Check if the file needs recompilation
         compilationState::RecordFile* fileRecord = findOrCreateFileRecord(rootFolder, relative);
-        // Compile based on file extension
-        std::string extension = filePath.extension().string();
-        if (extension == ".gc") {
-            compileGcFile(fileContent, filePath, outputIRPath, objFilePath, fileRecord);
-        } else if (extension == ".c") {
-            compileCFile(filePath, outputIRPath, objFilePath, fileRecord);
-        } else if (extension == ".rs") {
-            compileRustFile(filePath, outputIRPath, objFilePath, fileRecord);
-        } else {
-            errors::raiseCompilationError("Unsupported file type: " + filePath.string());
+        if (!fileRecord->tryStart()) return;
+
+        try {
+            // Compile based on file extension
+            std::string extension = filePath.extension().string();
+            if (extension == ".gc") {
+                parsed.entry.interface_hash = compileGcFile(*parsed.source, parsed.program, filePath, outputIRPath, objFilePath, fileRecord);
+            } else if (extension == ".c") {
+                compileCFile(filePath, outputIRPath, objFilePath, fileRecord);
+            } else if (extension == ".rs") {
+                compileRustFile(filePath, outputIRPath, objFilePath, fileRecord);
+            } else {
+                errors::raiseCompilationError("Unsupported file type: " + filePath.string());
+            }
+        } catch (const std::exception& e) {
+            // Wake up anything waiting on this file before reporting the error
+            fileRecord->markFailed(e.what());
+            throw;
         }
+
+        // Update file record
+        fileRecord->markDone();
     }
 
     /**
      * @brief Compiles a .gc source file.
      *
+     * @param fileContent The source of the .gc file.
+     * @param program The parsed program, shared through astCache.
      * @param filePath The path to the .gc file.
      * @param outputIRPath The path to the output LLVM IR file.
-     * @param objFilePath The path to the output object file.
+     * @param objFilePath The path to the output object file (bitcode with --lto).
      * @param fileRecord The record of the file being compiled.
+     * @return The hash of the module interface written for the file.
      */
-    void compileGcFile(
-        std::string fileContent, const std::filesystem::path& filePath, const std::filesystem::path& outputIRPath, const std::filesystem::path& objFilePath, compilationState::RecordFile* fileRecord) {
+    uint64_t compileGcFile(const std::string& fileContent,
+                           AST::Program* program,
+                           const std::filesystem::path& filePath,
+                           const std::filesystem::path& outputIRPath,
+                           const std::filesystem::path& objFilePath,
+                           compilationState::RecordFile* fileRecord) {
 // Debugging Lexer
 #ifdef DEBUG_LEXER
         if (filePath.filename() == "main.gc") {
-            debugLexer(Utils::readFileToString(filePath), filePath);
+            debugLexer(fileContent, filePath);
         }
 #endif
 
 // Debugging Parser
 #ifdef DEBUG_PARSER
         if (filePath.filename() == "main.gc") {
-            debugParser(Utils::readFileToString(filePath), filePath);
+            debugParser(program);
         }
 #endif
 
-        Lexer lexer(fileContent, filePath);
-        parser::Parser parser(&lexer);
-        auto program = parser.parseProgram();
+        auto relative = std::filesystem::relative(filePath, srcDir);
+        const std::string& fileOptimizationLevel = optimizationLevelFor(relative);
+
+        // A unity build compiles into the shared context, which only one file may use at a time
+        std::unique_lock<std::mutex> unityLock;
+        if (options.unity) unityLock = std::unique_lock<std::mutex>(unityMutex);
 
-        compiler::Compiler comp(fileContent, std::filesystem::absolute(filePath), fileRecord, buildDir, std::filesystem::relative(filePath, srcDir).string(), target_triple);
+        compiler::Compiler comp(fileContent, std::filesystem::absolute(filePath), fileRecord, buildDir, relative.string(), options.target_triple, options.unity ? unityContext.get() : nullptr);
+        comp.ast_cache = &astCache;
         comp.compile(program);
-        delete program;
 
-        // Write LLVM IR to file
-        std::error_code EC;
-        llvm::raw_fd_ostream irFile(outputIRPath.string(), EC, llvm::sys::fs::OF_None);
-        if (EC) { errors::raiseCompilationError("Could not open IR file " + outputIRPath.string() + ": " + EC.message()); }
-        comp.llvm_module->print(irFile, nullptr);
-        irFile.close();
+        if (options.unity) {
+            // Optimized & lowered with the rest of the project by finishUnity; calls
+            // between files resolve to direct calls inside the merged module
+            compiler::verifyModule(*comp.llvm_module, filePath.string());
+            if (llvm::Linker::linkModules(*unityModule, std::move(comp.llvm_module))) { errors::raiseCompilationError("Could not merge " + filePath.string() + " into the unity module"); }
+            if (options.verbose) { std::cout << "Merged .gc file into the unity module: " << filePath << std::endl; }
+            return compiler::writeInterface(program, comp.exported_names, compiler::interfacePath(buildDir, relative));
+        }
 
-        // Compile IR to object file
-        Utils::createDirectories(objFilePath.parent_path());
-        std::string optFlag = optimizationLevel.empty() ? "" : " -O" + optimizationLevel;
-        std::string clangCommand = "clang -c \"" + outputIRPath.string() + "\" -o \"" + objFilePath.string() + "\" -Woverride-module" + optFlag;
+        // Optimize in-process with the new pass manager
+        if (options.dumpOptIR) writeModuleIR(*comp.llvm_module, optIRDir / (relative.string() + ".before.ll"));
+        // With LTO a custom pipeline runs once, at link time
+        comp.optimize(fileOptimizationLevel, ltoMode == compiler::LTOMode::None ? options.passPipeline : "", ltoMode);
+        if (options.dumpOptIR) writeModuleIR(*comp.llvm_module, optIRDir / (relative.string() + ".after.ll"));
+
+        // Write LLVM IR to file only when asked for; codegen works on the in-memory module
+        if (options.emitLLVM) writeModuleIR(*comp.llvm_module, outputIRPath);
+
+        // gigly run: the module and its context go to the JIT, which lowers it function by function
+        if (options.jit) {
+            uint64_t interfaceHash = compiler::writeInterface(program, comp.exported_names, compiler::interfacePath(buildDir, relative));
+            std::lock_guard<std::mutex> lock(jitMutex);
+            jitModules.push_back({std::move(comp.owned_llvm_context), std::move(comp.llvm_module)});
+            if (options.verbose) { std::cout << "Compiled .gc file for the JIT: " << filePath << std::endl; }
+            return interfaceHash;
+        }
 
-        int clangResult;
-        std::string clangOutput = runCommand(clangCommand, clangResult);
-        if (clangResult != 0) {
-            errors::raiseCompilationError("Failed to convert " + outputIRPath.string() + " to " + objFilePath.string() + "\nCommand: " + clangCommand + "\nOutput: " + clangOutput);
+        // Lower the module straight to an object file, or keep it as bitcode for the LTO link.
+        // Bitcode is written first: code generation may still change the module
+        if (ltoMode == compiler::LTOMode::None) {
+            if (options.emitBC) comp.emitBitcodeFile(bitcodePathFor(relative));
+            comp.emitObjectFile(objFilePath, fileOptimizationLevel);
+        } else {
+            comp.emitBitcodeFile(objFilePath, ltoMode == compiler::LTOMode::Thin);
         }
 
-        // Update file record
-        fileRecord->compiled = true;
+        // Written after the object, so an interrupted build never leaves a new
+        // interface next to an old object
+        uint64_t interfaceHash = compiler::writeInterface(program, comp.exported_names, compiler::interfacePath(buildDir, relative));
 
-        if (verbose) { std::cout << "Compiled .gc file: " << filePath << std::endl; }
+        if (options.verbose) { std::cout << "Compiled .gc file: " << filePath << std::endl; }
+        return interfaceHash;
     }
 
     /**
@@ -260,13 +837,29 @@ class Compiler {
      * @param fileRecord The record of the file being compiled.
      */
     void compileCFile(const std::filesystem::path& filePath, const std::filesystem::path& outputIRPath, const std::filesystem::path& objFilePath, compilationState::RecordFile* fileRecord) {
-        // Compile to LLVM IR
-        std::string optFlag = optimizationLevel.empty() ? "" : " -O" + optimizationLevel;
-        std::string clangCommandIR = "clang -emit-llvm -S " + optFlag + " \"" + filePath.string() + "\" -o \"" + outputIRPath.string() + "\"";
+        const std::string& fileOptimizationLevel = optimizationLevelFor(std::filesystem::relative(filePath, srcDir));
+        std::string optFlag = fileOptimizationLevel.empty() ? "" : " -O" + fileOptimizationLevel;
 
-        int clangResultIR;
-        std::string clangOutputIR = runCommand(clangCommandIR, clangResultIR);
-        if (clangResultIR != 0) { errors::raiseCompilationError("Failed to compile " + filePath.string() + " to LLVM IR" + "\nCommand: " + clangCommandIR + "\nOutput: " + clangOutputIR); }
+        // Bitcode, then textual IR, only when asked for; the JIT runs the bitcode
+        if (options.emitBC || options.jit) {
+            std::string clangCommandBC = "clang -c -emit-llvm " + optFlag + " \"" + filePath.string() + "\" -o \"" + bitcodePathFor(std::filesystem::relative(filePath, srcDir)).string() + "\"";
+
+            int clangResultBC;
+            std::string clangOutputBC = runCommand(clangCommandBC, clangResultBC);
+            if (clangResultBC != 0) { errors::raiseCompilationError("Failed to compile " + filePath.string() + " to LLVM bitcode" + "\nCommand: " + clangCommandBC + "\nOutput: " + clangOutputBC); }
+        }
+        if (options.emitLLVM) {
+            std::string clangCommandIR = "clang -emit-llvm -S " + optFlag + " \"" + filePath.string() + "\" -o \"" + outputIRPath.string() + "\"";
+
+            int clangResultIR;
+            std::string clangOutputIR = runCommand(clangCommandIR, clangResultIR);
+            if (clangResultIR != 0) { errors::raiseCompilationError("Failed to compile " + filePath.string() + " to LLVM IR" + "\nCommand: " + clangCommandIR + "\nOutput: " + clangOutputIR); }
+        }
+        if (options.jit) {
+            std::lock_guard<std::mutex> lock(jitMutex);
+            jitBitcode.push_back(bitcodePathFor(std::filesystem::relative(filePath, srcDir)));
+            return;
+        }
 
         // Compile to object file
         std::string clangCommandObj = "clang -c \"" + filePath.string() + "\" -o \"" + objFilePath.string() + "\" " + optFlag;
@@ -275,10 +868,7 @@ class Compiler {
         std::string clangOutputObj = runCommand(clangCommandObj, clangResultObj);
         if (clangResultObj != 0) { errors::raiseCompilationError("Failed to compile " + filePath.string() + " to object file" + "\nCommand: " + clangCommandObj + "\nOutput: " + clangOutputObj); }
 
-        // Update file record
-        fileRecord->compiled = true;
-
-        if (verbose) { std::cout << "Compiled .c file: " << filePath << std::endl; }
+        if (options.verbose) { std::cout << "Compiled .c file: " << filePath << std::endl; }
     }
 
     /**
@@ -290,27 +880,33 @@ class Compiler {
      * @param fileRecord The record of the file being compiled.
      */
     void compileRustFile(const std::filesystem::path& filePath, const std::filesystem::path& outputIRPath, const std::filesystem::path& objFilePath, compilationState::RecordFile* fileRecord) {
-        std::filesystem::path irFilePath = outputIRPath.string() + ".ll";
-        Utils::createDirectories(irFilePath.parent_path());
+        auto relative = std::filesystem::relative(filePath, srcDir);
+        // Bitcode is the intermediate; textual IR is only written for --emit-llvm
+        std::filesystem::path bcFilePath = bitcodePathFor(relative);
 
-        // Compile Rust to LLVM IR
-        std::string rustcCommand = "rustc -emit=llvm-ir \"" + filePath.string() + "\" -o \"" + irFilePath.string() + "\"" + (optimizationLevel.empty() ? "" : " -C opt-level=" + optimizationLevel);
+        const std::string& fileOptimizationLevel = optimizationLevelFor(relative);
+
+        // Compile Rust to LLVM bitcode
+        std::string emit = "llvm-bc=\"" + bcFilePath.string() + "\"" + (options.emitLLVM ? ",llvm-ir=\"" + outputIRPath.string() + "\"" : "");
+        std::string rustcCommand = "rustc --emit=" + emit + " \"" + filePath.string() + "\"" + (fileOptimizationLevel.empty() ? "" : " -C opt-level=" + fileOptimizationLevel);
 
         int rustcResult;
         std::string rustcOutput = runCommand(rustcCommand, rustcResult);
-        if (rustcResult != 0) { errors::raiseCompilationError("Failed to compile Rust file " + filePath.string() + " to LLVM IR" + "\nCommand: " + rustcCommand + "\nOutput: " + rustcOutput); }
+        if (rustcResult != 0) { errors::raiseCompilationError("Failed to compile Rust file " + filePath.string() + " to LLVM bitcode" + "\nCommand: " + rustcCommand + "\nOutput: " + rustcOutput); }
+        if (options.jit) {
+            std::lock_guard<std::mutex> lock(jitMutex);
+            jitBitcode.push_back(bcFilePath);
+            return;
+        }
 
-        // Compile LLVM IR to object file
-        std::string clangCommand = "clang -c \"" + irFilePath.string() + "\" -o \"" + objFilePath.string() + "\"" + (optimizationLevel.empty() ? "" : " -O" + optimizationLevel);
+        // Compile LLVM bitcode to object file
+        std::string clangCommand = "clang -c \"" + bcFilePath.string() + "\" -o \"" + objFilePath.string() + "\"" + (fileOptimizationLevel.empty() ? "" : " -O" + fileOptimizationLevel);
 
         int clangResult;
         std::string clangOutput = runCommand(clangCommand, clangResult);
-        if (clangResult != 0) { errors::raiseCompilationError("Failed to convert " + irFilePath.string() + " to " + objFilePath.string() + "\nCommand: " + clangCommand + "\nOutput: " + clangOutput); }
-
-        // Update file record
-        fileRecord->compiled = true;
+        if (clangResult != 0) { errors::raiseCompilationError("Failed to convert " + bcFilePath.string() + " to " + objFilePath.string() + "\nCommand: " + clangCommand + "\nOutput: " + clangOutput); }
 
-        if (verbose) { std::cout << "Compiled Rust file: " << filePath << std::endl; }
+        if (options.verbose) { std::cout << "Compiled Rust file: " << filePath << std::endl; }
     }
 
     /**
@@ -328,7 +924,7 @@ class Compiler {
             std::cerr << "Error: Could not open debug output file " << outputPath.string() << std::endl;
             return;
         }
-        while (debugLexer.current_char != "") {
+        while (static_cast<size_t>(debugLexer.pos) < debugLexer.source.size()) {
             token::Token token = debugLexer.nextToken();
             debugOutput << token.toString(false) << std::endl;
         }
@@ -339,13 +935,10 @@ class Compiler {
     /**
      * @brief Handles parser debugging.
      *
-     * @param fileContent The content of the source file.
+     * @param program The program parsed for compilation.
      */
-    void debugParser(const std::string& fileContent, const std::filesystem::path& file_path) const {
+    void debugParser(AST::Program* program) const {
 #ifdef DEBUG_PARSER
-        Lexer debug_lexer(fileContent, file_path);
-        parser::Parser debugParser(&debug_lexer);
-        auto program = debugParser.parseProgram();
         std::cout << "=========== Parser Debug ===========" << std::endl;
         std::filesystem::path outputPath = buildDir / "parser_output.yaml";
         std::ofstream file(outputPath, std::ios::trunc);
@@ -355,7 +948,6 @@ class Compiler {
         } else {
             errors::raiseCompilationError("Unable to open parser debug output file: " + outputPath.string());
         }
-        delete program;
 #endif
     }
 };
@@ -363,32 +955,339 @@ class Compiler {
 // =======================================
 // CLI Setup Function
 // =======================================
-void setupCLI(CLI::App& app, std::filesystem::path& inputFolderPath, std::string& optimizationLevel, std::filesystem::path& executablePath, bool& verbose, std::string& target_triple) {
+void setupCLI(CLI::App& app, std::filesystem::path& inputFolderPath, std::filesystem::path& executablePath, BuildOptions& options, std::vector<std::string>& fileOptimizationLevels) {
     app.add_option("input_folder", inputFolderPath, "Input folder path")->required()->check(CLI::ExistingDirectory);
-    app.add_option("-O,--optimization", optimizationLevel, "Optimization level (O1, O2, O3, Os, Ofast)")->default_val("");
+    app.add_option("-O,--optimization", options.optimizationLevel, "Optimization level (0, 1, 2, 3, s, z, fast)")->default_val("");
+    app.add_option("--file-opt", fileOptimizationLevels, "Per-file optimization level as <path relative to src>=<level>, e.g. math/vec.gc=3");
+    app.add_option("--passes", options.passPipeline, "Custom LLVM pass pipeline used instead of the -O pipeline (e.g. \"function(mem2reg,instcombine)\")")->default_val("");
+    app.add_flag("--dump-opt-ir", options.dumpOptIR, "Write the IR of every file before and after optimization to build/opt-ir");
     app.add_option("-o,--output", executablePath, "Output executable path")->required();
-    app.add_flag("-v,--verbose", verbose, "Enable verbose output");
-    app.add_option("--target", target_triple, "Override target triple for cross-compilation (e.g. aarch64-unknown-linux-gnu). Default: host native.")->default_val("");
+    app.add_flag("-v,--verbose", options.verbose, "Enable verbose output");
+    app.add_option("--target", options.target_triple, "Override target triple for cross-compilation (e.g. aarch64-unknown-linux-gnu). Default: host native.")->default_val("");
+    app.add_flag("--emit-llvm", options.emitLLVM, "Also write textual LLVM IR for every file to build/ir (for debugging)");
+    app.add_flag("--emit-bc", options.emitBC, "Also write LLVM bitcode for every file to build/bc");
+    app.add_flag("--gc-sections", options.gcSections, "Let the linker drop functions and data nothing references");
+    app.add_option("--link-threads", options.linkThreads, "Number of threads the embedded linker may use. Default: same as --jobs.")->default_val(0);
+    auto lto = app.add_option("--lto", options.lto, "Optimize the whole program at link time: full or thin")->check(CLI::IsMember({"full", "thin"}));
+    app.add_flag("--unity", options.unity, "Compile every .gc file into one LLVM module")->excludes(lto);
+    auto watch = app.add_flag("--watch", options.watch, "Keep running and rebuild whenever a file under src/ changes");
+    app.add_option("--watch-run", options.watchRun, "Command to run after every successful --watch build, e.g. the executable")->needs(watch);
+    app.add_flag("--time-trace", options.timeTrace, "Write a Chrome trace of the build to build/time-trace.json and print the slowest files and functions");
+    app.add_option("--time-trace-top", options.timeTraceTop, "Number of files and functions listed in the --time-trace summary")->default_val(10);
+    app.add_option("--cache-dir", options.cacheDir, "Share compiled .gc files through the object cache in this directory");
+    app.add_flag("--cache", options.cache, "Share compiled .gc files between build directories through $XDG_CACHE_HOME/gigly");
+    app.add_option("--cache-max-size", options.cacheLimit, "Size in MiB the object cache is trimmed to")->default_val(5120);
+    app.add_option("-j,--jobs", options.jobs, "Number of files to compile in parallel. Default: number of cores.")->default_val(buildGraph::ThreadPool::defaultJobs());
 }
 
 // =======================================
 // Main Function
 // =======================================
-int main(int argc, char* argv[]) {
+/**
+ * @brief Loads the programs & interfaces of a project into a cache that outlives its builds.
+ *
+ * Only files last written before the successful build started are loaded; the
+ * build saw those very contents, so they are known to parse.
+ */
+void warmCache(compilationState::ASTCache& astCache, const std::filesystem::path& srcDir, const std::filesystem::path& buildDir, std::filesystem::file_time_type started) {
+    auto unchanged = [started](const std::filesystem::path& path) {
+        std::error_code ec;
+        auto written = std::filesystem::last_write_time(path, ec);
+        return !ec && written < started;
+    };
+
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator it(srcDir, ec), end; !ec && it != end; it.increment(ec)) {
+        const auto& filePath = it->path();
+        if (!it->is_regular_file() || filePath.extension() != ".gc" || !unchanged(filePath)) continue;
+        astCache.program(filePath);
+        std::filesystem::path interface = compiler::interfacePath(buildDir, std::filesystem::relative(filePath, srcDir));
+        if (unchanged(interface)) astCache.interface(interface, [&interface]() { return compiler::readInterface(interface); });
+    }
+}
+
+/**
+ * @brief Compiles & links a project once.
+ *
+ * @return int Exit status code.
+ */
+int buildProject(const std::filesystem::path& srcDir, const std::filesystem::path& buildDir, const std::filesystem::path& executablePath, const BuildOptions& options, compilationState::ASTCache& astCache) {
+    if (options.timeTrace) timeTrace::enable();
+
+    // Initialize Compiler with verbose flag and optional target triple
+    Compiler compiler(srcDir, buildDir, options, astCache);
+
+    // Initialize rootFolder directly
+    compilationState::RecordFolder rootFolder;
+
+    // Compile All Files
+    try {
+        compiler.compileAll(&rootFolder);
+    } catch (const std::exception& e) {
+        std::cerr << "Compilation failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Link Object Files into Executable
+    int status = compiler.linkAll(executablePath);
+
+    if (options.timeTrace) {
+        std::filesystem::path tracePath = buildDir / "time-trace.json";
+        if (!timeTrace::writeChromeTrace(tracePath, "gigly")) std::cerr << "Warning: could not write time trace " << tracePath.string() << std::endl;
+        else std::cout << "Time trace written to " << tracePath.string() << std::endl;
+        timeTrace::printSummary(std::cout, options.timeTraceTop);
+    }
+    return status;
+}
+
+/**
+ * @brief `gigly reload-build [options] <project> <dir>`: the rebuild of `gigly run --hot-reload`.
+ *
+ * Compiles the project as `gigly run` does and writes its .gc modules to
+ * `<dir>` as bitcode, `0.bc`, `1.bc`, ... in the order the JIT loads them.
+ * Started by reloadProgram in a process of its own, so a failed build cannot
+ * end the running program.
+ *
+ * @return int Exit status code.
+ */
+int reloadBuild(int argc, char* argv[]) {
+    CLI::App app{"Compile a project for a hot reload of gigly run"};
+    std::filesystem::path inputFolderPath;
+    std::filesystem::path outputDir;
+    BuildOptions options;
+    options.jit = true;
+    app.add_option("input_folder", inputFolderPath, "Input folder path")->required()->check(CLI::ExistingDirectory);
+    app.add_option("output_dir", outputDir, "Directory the bitcode of the modules is written to")->required();
+    app.add_option("-O,--optimization", options.optimizationLevel, "Optimization level (0, 1, 2, 3, s, z, fast)")->default_val("");
+    app.add_flag("-v,--verbose", options.verbose, "Enable verbose output");
+    app.add_flag("--emit-llvm", options.emitLLVM, "Also write textual LLVM IR for every file to build/ir (for debugging)");
+    app.add_option("-j,--jobs", options.jobs, "Number of files to compile in parallel. Default: number of cores.")->default_val(buildGraph::ThreadPool::defaultJobs());
+    CLI11_PARSE(app, argc, argv);
+
+    compilationState::ASTCache astCache;
+    Compiler compiler(inputFolderPath / "src", inputFolderPath / "build", options, astCache);
+    compilationState::RecordFolder rootFolder;
+    try {
+        compiler.compileAll(&rootFolder);
+    } catch (const std::exception& e) {
+        std::cerr << "Compilation failed: " << e.what() << std::endl;
+        return 1;
+    }
+    auto modules = compiler.takeJITModules();
+    Utils::createDirectories(outputDir);
+    for (size_t idx = 0; idx < modules.size(); ++idx) compiler::emitBitcodeFile(*modules[idx].module, outputDir / (std::to_string(idx) + ".bc"));
+    return 0;
+}
+
+/**
+ * @brief Waits briefly for .gc files to change and rebuilds the program, for `gigly run --hot-reload`.
+ *
+ * The running program lives in this process, along with the threads of the
+ * JIT, so the project is compiled once by a `gigly reload-build` process
+ * spawned for it: an error there ends that process, not the program, which
+ * keeps running the code it has. The modules come back as bitcode.
+ *
+ * @return The rebuilt .gc modules; empty if nothing changed or the rebuild failed.
+ */
+std::vector<jit::JITModule> reloadProgram(watch::SourceWatcher& watcher, const std::filesystem::path& projectDir, const std::filesystem::path& buildDir, const BuildOptions& options) {
+    auto changed = watcher.wait(std::chrono::milliseconds(100), std::chrono::milliseconds(250));
+    if (changed.empty()) return {};
+    if (std::none_of(changed.begin(), changed.end(), [](const std::filesystem::path& path) { return path.extension() == ".gc"; })) {
+        std::cerr << "Hot reload: only .gc files are reloaded; restart to pick up " << changed.front().string() << std::endl;
+        return {};
+    }
+
+    std::filesystem::path bitcodeDir = buildDir / "hot-reload";
+    std::error_code ec;
+    std::filesystem::remove_all(bitcodeDir, ec);
+    std::string executable = llvm::sys::fs::getMainExecutable(nullptr, reinterpret_cast<void*>(&reloadBuild));
+    std::vector<std::string> args = {executable, "reload-build", projectDir.string(), bitcodeDir.string(), "-j", std::to_string(options.jobs)};
+    if (!options.optimizationLevel.empty()) args.insert(args.end(), {"-O", options.optimizationLevel});
+    if (options.verbose) args.push_back("-v");
+    if (options.emitLLVM) args.push_back("--emit-llvm");
+    std::vector<llvm::StringRef> argv(args.begin(), args.end());
+    std::string error;
+    if (llvm::sys::ExecuteAndWait(executable, argv, std::nullopt, {}, 0, 0, &error) != 0) {
+        if (!error.empty()) std::cerr << "Hot reload: " << error << std::endl;
+        std::cerr << "Hot reload: the rebuild failed; the program keeps running the previous version." << std::endl;
+        return {};
+    }
+
+    std::vector<jit::JITModule> modules;
+    for (size_t idx = 0;; ++idx) {
+        std::filesystem::path path = bitcodeDir / (std::to_string(idx) + ".bc");
+        if (!std::filesystem::exists(path)) break;
+        jit::JITModule module;
+        module.context = std::make_unique<llvm::LLVMContext>();
+        auto buffer = llvm::MemoryBuffer::getFile(path.string());
+        if (!buffer) {
+            std::cerr << "Hot reload: could not read " << path.string() << ": " << buffer.getError().message() << std::endl;
+            return {};
+        }
+        auto parsed = llvm::parseBitcodeFile((*buffer)->getMemBufferRef(), *module.context);
+        if (!parsed) {
+            std::cerr << "Hot reload: could not read " << path.string() << ": " << llvm::toString(parsed.takeError()) << std::endl;
+            return {};
+        }
+        module.module = std::move(*parsed);
+        // Named after its source again, like the module compiled in this process
+        module.module->setModuleIdentifier(module.module->getSourceFileName());
+        modules.push_back(std::move(module));
+    }
+    return modules;
+}
+
+/**
+ * @brief `gigly run [options] <project> [args...]`: compiles the project in memory and runs it in the JIT.
+ *
+ * Everything after the project folder is passed to the program. Module
+ * interfaces are still written to build/, for the imports; objects are not.
+ *
+ * @return int The exit status of the program.
+ */
+int runProgram(int argc, char* argv[], compilationState::ASTCache& astCache) {
+    CLI::App app{"Compile a project in memory and run it"};
+    app.prefix_command(); // Arguments after the project belong to the program
+    std::filesystem::path inputFolderPath;
+    BuildOptions options;
+    options.jit = true;
+    bool tiered = false;
+    unsigned tierThreshold = 0;
+    bool hotReload = false;
+    app.add_option("input_folder", inputFolderPath, "Input folder path")->required()->check(CLI::ExistingDirectory);
+    auto optimization = app.add_option("-O,--optimization", options.optimizationLevel, "Optimization level (0, 1, 2, 3, s, z, fast)")->default_val("");
+    auto tieredFlag = app.add_flag("--tiered", tiered, "Start every function unoptimized and re-optimize hot ones at -O3 in the background")->excludes(optimization);
+    app.add_option("--tier-threshold", tierThreshold, "Calls plus loop iterations after which a --tiered function is re-optimized")->default_val(10000)->check(CLI::PositiveNumber)->needs(tieredFlag);
+    app.add_flag("--hot-reload", hotReload, "Recompile the functions of changed .gc files and swap them into the running program")->excludes(tieredFlag);
+    app.add_flag("-v,--verbose", options.verbose, "Enable verbose output");
+    app.add_flag("--emit-llvm", options.emitLLVM, "Also write textual LLVM IR for every file to build/ir (for debugging)");
+    app.add_option("-j,--jobs", options.jobs, "Number of files to compile in parallel. Default: number of cores.")->default_val(buildGraph::ThreadPool::defaultJobs());
+    CLI11_PARSE(app, argc, argv);
+
+    std::filesystem::path srcDir = inputFolderPath / "src";
+    std::filesystem::path buildDir = inputFolderPath / "build";
+    if (!std::filesystem::exists(srcDir)) {
+        std::cerr << "Error: Source directory " << srcDir << " does not exist." << std::endl;
+        return 1;
+    }
+
+    // Watching starts before the first build, so edits made during it are reloaded too
+    std::unique_ptr<watch::SourceWatcher> watcher;
+    jit::ReloadFn reload;
+    if (hotReload) {
+        watcher = std::make_unique<watch::SourceWatcher>(srcDir);
+        if (!watcher->valid()) {
+            std::cerr << "Error: could not watch " << srcDir.string() << " for changes." << std::endl;
+            return 1;
+        }
+        reload = [&]() { return reloadProgram(*watcher, inputFolderPath, buildDir, options); };
+    }
+
+    Compiler compiler(srcDir, buildDir, options, astCache);
+    compilationState::RecordFolder rootFolder;
+    try {
+        compiler.compileAll(&rootFolder);
+    } catch (const std::exception& e) {
+        std::cerr << "Compilation failed: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << std::flush;
+    return compiler.runJIT(inputFolderPath.filename().string(), app.remaining(), tiered ? tierThreshold : 0, std::move(reload));
+}
+
+/**
+ * @brief `gigly repl [options]`: an interactive prompt that compiles and runs each input in the JIT.
+ *
+ * @return int Exit status code.
+ */
+int runRepl(int argc, char* argv[]) {
+    CLI::App app{"Read, compile and run GigglyCode interactively"};
+    repl::Options options;
+    app.add_option("-O,--optimization", options.optimizationLevel, "Optimization level (0, 1, 2, 3, s, z, fast)")->default_val("");
+    app.add_flag("-v,--verbose", options.verbose, "Print the LLVM IR of every input");
+    CLI11_PARSE(app, argc, argv);
+    return repl::run(options);
+}
+
+/**
+ * @brief Rebuilds the project every time a file under src/ changes (--watch).
+ *
+ * Each build runs in a forked child, so an error ends that build rather than
+ * the watcher. Between builds the watcher keeps the AST cache warm; which
+ * files an edit makes stale is left to the build's manifest, which skips
+ * importers whose imports kept their interface hash.
+ *
+ * @return int Exit status code; only returns if src/ cannot be watched.
+ */
+int watchProject(const std::filesystem::path& srcDir, const std::filesystem::path& buildDir, const std::filesystem::path& executablePath, const BuildOptions& options, compilationState::ASTCache& astCache) {
+    watch::SourceWatcher watcher(srcDir);
+    if (!watcher.valid()) {
+        std::cerr << "Error: could not watch " << srcDir.string() << " for changes." << std::endl;
+        return 1;
+    }
+
+    while (watcher.valid()) {
+        auto started = std::filesystem::file_time_type::clock::now();
+        int status = Utils::runInChild([&]() { return buildProject(srcDir, buildDir, executablePath, options, astCache); });
+        if (status == 0) {
+            warmCache(astCache, srcDir, buildDir, started);
+            if (!options.watchRun.empty()) {
+                std::cout << "Running: " << options.watchRun << std::endl;
+                int runStatus = std::system(options.watchRun.c_str());
+                if (runStatus != 0) std::cout << "Command exited with status " << runStatus << std::endl;
+            }
+        } else {
+            std::cout << "Build failed with exit status " << status << std::endl;
+        }
+
+        std::cout << "Watching " << srcDir.string() << " for changes..." << std::endl;
+        std::vector<std::filesystem::path> changed;
+        while (changed.empty() && watcher.valid()) {
+            for (const auto& path : watcher.wait()) {
+                if (Compiler::isSupportedFile(path)) changed.push_back(path);
+            }
+        }
+
+        std::cout << "Changed: ";
+        for (size_t idx = 0; idx < changed.size(); ++idx) std::cout << (idx ? ", " : "") << changed[idx].string();
+        std::cout << std::endl;
+
+        astCache.dropStale();
+    }
+    std::cerr << "Error: " << srcDir.string() << " is no longer watched." << std::endl;
+    return 1;
+}
+
+/**
+ * @brief Runs one build as described by the command line.
+ *
+ * @param astCache Cache the build reads sources & programs through.
+ * @return int Exit status code.
+ */
+int runBuild(int argc, char* argv[], compilationState::ASTCache& astCache) {
     // Initialize CLI
     CLI::App app{"Folder Compiler"};
     std::filesystem::path inputFolderPath;
-    std::string optimizationLevel;
     std::filesystem::path executablePath;
-    bool verbose = false;
-    std::string target_triple;
-    setupCLI(app, inputFolderPath, optimizationLevel, executablePath, verbose, target_triple);
+    BuildOptions options;
+    std::vector<std::string> fileOptimizationLevels;
+    setupCLI(app, inputFolderPath, executablePath, options, fileOptimizationLevels);
     CLI11_PARSE(app, argc, argv);
+    if (!options.cacheDir.empty()) options.cache = true;
 
-    if (verbose) {
+    for (const auto& entry : fileOptimizationLevels) {
+        auto separator = entry.rfind('=');
+        if (separator == std::string::npos || separator == 0) {
+            std::cerr << "Error: --file-opt expects <path>=<level>, got '" << entry << "'" << std::endl;
+            return 1;
+        }
+        options.fileOptimizationLevels[std::filesystem::path(entry.substr(0, separator)).lexically_normal().string()] = entry.substr(separator + 1);
+    }
+
+    if (options.verbose) {
         std::cout << "Verbose mode enabled." << std::endl;
-        if (!target_triple.empty()) {
-            std::cout << "Target triple override: " << target_triple << std::endl;
+        if (!options.target_triple.empty()) {
+            std::cout << "Target triple override: " << options.target_triple << std::endl;
         }
     }
 
@@ -408,16 +1307,59 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Initialize Compiler with verbose flag and optional target triple
-    Compiler compiler(srcDir, buildDir, optimizationLevel, verbose, target_triple);
+    if (options.watch) return watchProject(srcDir, buildDir, executablePath, options, astCache);
+    return buildProject(srcDir, buildDir, executablePath, options, astCache);
+}
 
-    // Initialize rootFolder directly
-    compilationState::RecordFolder rootFolder;
+/**
+ * @brief Loads the programs & interfaces of a project built by the compile server.
+ */
+void warmServerCache(compilationState::ASTCache& astCache, const std::filesystem::path& workingDirectory, int argc, char* argv[], std::filesystem::file_time_type started) {
+    CLI::App app;
+    std::filesystem::path inputFolderPath;
+    std::filesystem::path executablePath;
+    BuildOptions options;
+    std::vector<std::string> fileOptimizationLevels;
+    setupCLI(app, inputFolderPath, executablePath, options, fileOptimizationLevels);
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::Error&) {
+        return;
+    }
+    warmCache(astCache, workingDirectory / inputFolderPath / "src", workingDirectory / inputFolderPath / "build", started);
+}
 
-    // Compile All Files
-    compiler.compileAll(&rootFolder);
+int main(int argc, char* argv[]) {
+    // The compile server has its own entry points, ahead of the build options
+    if (argc >= 3 && std::string(argv[1]) == "--serve") {
+        compilationState::ASTCache astCache; // Lives as long as the daemon
+        // Targets are set up once, here, instead of in every build
+        compiler::TargetRegistry::instance().dataLayout(compiler::TargetKey{});
+
+        compileServer::Hooks hooks;
+        hooks.refresh = [&astCache]() { astCache.dropStale(); };
+        hooks.build = [&astCache](int buildArgc, char* buildArgv[]) { return runBuild(buildArgc, buildArgv, astCache); };
+        hooks.warm = [&astCache](const std::filesystem::path& workingDirectory, int buildArgc, char* buildArgv[], std::filesystem::file_time_type started) {
+            warmServerCache(astCache, workingDirectory, buildArgc, buildArgv, started);
+        };
+        return compileServer::serve(argv[2], hooks);
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--server") {
+        std::vector<std::string> args(argv + 3, argv + argc);
+        // A watch never finishes, so it would hold the daemon, and run & repl need this terminal;
+        // they run here instead
+        bool watching = std::find(args.begin(), args.end(), "--watch") != args.end();
+        bool interactive = !args.empty() && (args[0] == "run" || args[0] == "repl");
+        if (auto status = watching || interactive ? std::nullopt : compileServer::forward(argv[2], args)) return *status;
+        // No daemon: build in this process instead
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
+    }
 
-    // Link Object Files into Executable
-    return compiler.linkAll(executablePath);
-    return 0;
-}
\ No newline at end of file
+    if (argc >= 2 && std::string(argv[1]) == "repl") return runRepl(argc - 1, argv + 1);
+    compilationState::ASTCache astCache;
+    if (argc >= 2 && std::string(argv[1]) == "run") return runProgram(argc - 1, argv + 1, astCache);
+    if (argc >= 2 && std::string(argv[1]) == "reload-build") return reloadBuild(argc - 1, argv + 1);
+    return runBuild(argc, argv, astCache);
+}
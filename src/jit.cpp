@@ -0,0 +1,626 @@
+#include "jit.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <llvm/Analysis/CFG.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/IndirectionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/TargetProcess/TargetExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "compiler/codegen.hpp"
+#include "compiler/optimizer.hpp"
+#include "time_trace.hpp"
+
+namespace jit {
+
+// Reads the bitcode of a C or Rust file into a context of its own
+static llvm::Expected<llvm::orc::ThreadSafeModule> loadBitcode(const std::filesystem::path& path) {
+    auto buffer = llvm::MemoryBuffer::getFile(path.string());
+    if (!buffer) return llvm::createStringError(buffer.getError(), path.string() + ": " + buffer.getError().message());
+    auto context = std::make_unique<llvm::LLVMContext>();
+    auto module = llvm::parseBitcodeFile((*buffer)->getMemBufferRef(), *context);
+    if (!module) return module.takeError();
+    return llvm::orc::ThreadSafeModule(std::move(*module), std::move(context));
+}
+
+// Every module of the program, the .gc ones first, with the JIT's data layout
+static llvm::Expected<std::vector<llvm::orc::ThreadSafeModule>> collectModules(RunOptions& options, const llvm::DataLayout& layout) {
+    std::vector<llvm::orc::ThreadSafeModule> modules;
+    for (auto& [context, module] : options.modules) modules.emplace_back(std::move(module), std::move(context));
+    options.modules.clear();
+    for (const auto& path : options.bitcode) {
+        auto module = loadBitcode(path);
+        if (!module) return module.takeError();
+        modules.push_back(std::move(*module));
+    }
+    // Built for the host triple, but the JIT has the final say on the layout
+    for (auto& module : modules) module.withModuleDo([&](llvm::Module& m) { m.setDataLayout(layout); });
+    return modules;
+}
+
+// libc & everything else the program declares but does not define
+static llvm::Error addProcessSymbols(llvm::orc::LLJIT& jit) {
+    auto processSymbols = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit.getDataLayout().getGlobalPrefix());
+    if (!processSymbols) return processSymbols.takeError();
+    jit.getMainJITDylib().addGenerator(std::move(*processSymbols));
+    return llvm::Error::success();
+}
+
+// Runs the static constructors, `main` and the destructors
+static llvm::Error runMain(llvm::orc::LLJIT& jit, const RunOptions& options, int& exitCode) {
+    auto entry = jit.lookup("main");
+    if (!entry) return entry.takeError();
+    if (auto error = jit.initialize(jit.getMainJITDylib())) return error;
+    exitCode = llvm::orc::runAsMain(entry->toPtr<int (*)(int, char*[])>(), options.args, options.programName);
+    return jit.deinitialize(jit.getMainJITDylib());
+}
+
+namespace {
+
+constexpr const char* TIER_UP_HOOK = "__gigly_tier_up";
+constexpr const char* TIER0_SUFFIX = "$tier0";
+constexpr const char* TIER1_SUFFIX = "$tier1";
+constexpr const char* VERSION_SUFFIX = "$v";
+
+/**
+ * @class TieredProgram
+ * @brief The modules of a `gigly run --tiered` program and the thread that re-optimizes them.
+ *
+ * Every function `f` a module defines is called through an indirect stub
+ * named `f`. The stub first points at `f$tier0`, the unoptimized body, which
+ * counts its calls and loop back-edges. When the count reaches the threshold
+ * the body calls the tier-up hook once; the worker then optimizes a pristine
+ * copy of `f` at -O3 (with the other functions of its module available for
+ * inlining), lowers it as `f$tier1` and points the stub at it. Calls already
+ * in progress finish in the old body; there is no on-stack replacement.
+ */
+class TieredProgram {
+  public:
+    TieredProgram(llvm::orc::LLJIT& jit, compiler::TargetKey target, unsigned threshold, bool verbose)
+        : jit(jit), target(std::move(target)), threshold(threshold), verbose(verbose), stubs(llvm::orc::createLocalIndirectStubsManagerBuilder(jit.getTargetTriple())()) {}
+    TieredProgram(const TieredProgram&) = delete;
+    TieredProgram& operator=(const TieredProgram&) = delete;
+    ~TieredProgram() { stop(); }
+
+    /**
+     * @brief Instruments a module and adds it to the JIT as tier 0.
+     */
+    llvm::Error add(llvm::orc::ThreadSafeModule module) {
+        module.withModuleDo([this](llvm::Module& m) { prepare(m); });
+        return jit.addIRModule(std::move(module));
+    }
+
+    /**
+     * @brief Points every stub at its tier 0 body and starts the worker.
+     */
+    llvm::Error start() {
+        if (!stubs) return llvm::createStringError(llvm::inconvertibleErrorCode(), "indirect stubs are not supported on " + jit.getTargetTriple().str());
+        llvm::orc::SymbolMap symbols;
+        symbols[jit.mangleAndIntern(TIER_UP_HOOK)] = {llvm::orc::ExecutorAddr::fromPtr(&TieredProgram::tierUp), llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+        for (const auto& function : functions) {
+            if (auto error = stubs->createStub(function.name, llvm::orc::ExecutorAddr(), llvm::JITSymbolFlags::Exported)) return error;
+            symbols[jit.mangleAndIntern(function.name)] = {stubs->findStub(function.name, true).getAddress(), llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+        }
+        if (auto error = jit.getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(symbols)))) return error;
+
+        // Lowers every module at -O0, now that the stubs they call exist
+        for (const auto& function : functions) {
+            auto body = jit.lookup(function.name + TIER0_SUFFIX);
+            if (!body) return body.takeError();
+            if (auto error = stubs->updatePointer(function.name, *body)) return error;
+        }
+        worker = std::thread([this]() { work(); });
+        return llvm::Error::success();
+    }
+
+    /**
+     * @brief Stops the worker; a function being optimized is finished first.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (worker.joinable()) worker.join();
+    }
+
+  private:
+    struct TieredFunction {
+        size_t module;    ///< Index into pristine
+        std::string name; ///< Name of the stub; the bodies carry TIER0_SUFFIX & TIER1_SUFFIX
+    };
+
+    // Called by a tier 0 body whose counter reached the threshold
+    static void tierUp(TieredProgram* program, uint64_t id) {
+        {
+            std::lock_guard<std::mutex> lock(program->mutex);
+            program->hot.push_back(id);
+        }
+        program->wake.notify_one();
+    }
+
+    void prepare(llvm::Module& module) {
+        size_t index = pristine.size();
+        // Tier 1 bodies live in modules of their own, so nothing may stay module-local
+        for (auto& global : module.global_values()) {
+            if (!global.hasLocalLinkage()) continue;
+            global.setName((global.hasName() ? global.getName().str() : "__gigly_anon") + ".m" + std::to_string(index));
+            global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            global.setVisibility(llvm::GlobalValue::DefaultVisibility);
+            global.setDSOLocal(false);
+        }
+
+        // Functions with one definition only; linkonce & weak ones may be defined by
+        // several modules. `main` runs once, so a faster body would never be entered
+        std::vector<llvm::Function*> tiered;
+        for (auto& function : module) {
+            if (function.isDeclaration() || !function.hasExternalLinkage() || function.getName() == "main") continue;
+            tiered.push_back(&function);
+        }
+
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(module, stream);
+        pristine.emplace_back(bitcode.begin(), bitcode.end());
+
+        auto& context = module.getContext();
+        auto* pointer = llvm::PointerType::getUnqual(context);
+        llvm::FunctionCallee hook = module.getOrInsertFunction(TIER_UP_HOOK, llvm::Type::getVoidTy(context), pointer, llvm::Type::getInt64Ty(context));
+        for (auto* function : tiered) {
+            std::string name = function->getName().str();
+            function->setName(name + TIER0_SUFFIX);
+            // Callers, including this body, go through the stub
+            auto* stub = llvm::Function::Create(function->getFunctionType(), llvm::GlobalValue::ExternalLinkage, name, module);
+            stub->setCallingConv(function->getCallingConv());
+            stub->setAttributes(function->getAttributes());
+            function->replaceAllUsesWith(stub);
+
+            instrument(*function, functions.size(), hook, pointer);
+            functions.push_back({index, name});
+        }
+    }
+
+    // Counts the calls & loop iterations of a tier 0 body; the one reaching the threshold calls the hook
+    void instrument(llvm::Function& function, uint64_t id, llvm::FunctionCallee hook, llvm::PointerType* pointer) {
+        auto& context = function.getContext();
+        auto* counter = new llvm::GlobalVariable(*function.getParent(), llvm::Type::getInt32Ty(context), false, llvm::GlobalValue::InternalLinkage, llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0), function.getName() + "$count");
+
+        // After the allocas, so they stay in the entry block
+        std::vector<llvm::Instruction*> points;
+        auto entry = function.getEntryBlock().begin();
+        while (llvm::isa<llvm::AllocaInst>(*entry)) ++entry;
+        points.push_back(&*entry);
+        llvm::SmallVector<std::pair<const llvm::BasicBlock*, const llvm::BasicBlock*>, 8> backedges;
+        llvm::FindFunctionBackedges(function, backedges);
+        std::unordered_set<const llvm::BasicBlock*> sources;
+        for (const auto& [from, to] : backedges) {
+            if (sources.insert(from).second) points.push_back(const_cast<llvm::BasicBlock*>(from)->getTerminator());
+        }
+
+        for (auto* point : points) {
+            llvm::IRBuilder<> builder(point);
+            auto* previous = builder.CreateAtomicRMW(llvm::AtomicRMWInst::Add, counter, builder.getInt32(1), llvm::MaybeAlign(4), llvm::AtomicOrdering::Monotonic);
+            auto* hot = builder.CreateICmpEQ(previous, builder.getInt32(threshold - 1));
+            auto* call = llvm::SplitBlockAndInsertIfThen(hot, point, false);
+            builder.SetInsertPoint(call);
+            builder.CreateCall(hook, {builder.CreateIntToPtr(builder.getInt64(reinterpret_cast<uintptr_t>(this)), pointer), builder.getInt64(id)});
+        }
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() { return stopping || !hot.empty(); });
+            if (stopping) return;
+            size_t id = hot.front();
+            hot.pop_front();
+            lock.unlock();
+            if (auto error = optimize(functions[id])) std::cerr << "Warning: could not optimize " << functions[id].name << ": " << llvm::toString(std::move(error)) << std::endl;
+            lock.lock();
+        }
+    }
+
+    llvm::Error optimize(const TieredFunction& function) {
+        timeTrace::Scope trace("Tier up", function.name);
+        llvm::LLVMContext context;
+        auto parsed = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(pristine[function.module].data(), pristine[function.module].size()), function.name), context);
+        if (!parsed) return parsed.takeError();
+        auto& module = **parsed;
+        module.setModuleIdentifier(function.name + TIER1_SUFFIX);
+
+        // Only the hot function is emitted; the rest of its module stays
+        // around for the inliner, and whatever is not inlined goes through the stubs
+        for (auto& other : module) {
+            if (other.isDeclaration()) continue;
+            other.setComdat(nullptr);
+            // C files built without -O carry these; the point of tier 1 is to optimize
+            if (other.hasFnAttribute(llvm::Attribute::OptimizeNone)) {
+                other.removeFnAttr(llvm::Attribute::OptimizeNone);
+                other.removeFnAttr(llvm::Attribute::NoInline);
+            }
+            if (other.getName() == function.name) continue;
+            other.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+            other.setDSOLocal(false);
+        }
+        for (auto& global : llvm::make_early_inc_range(module.globals())) {
+            if (global.getName().starts_with("llvm.")) {
+                global.eraseFromParent(); // Constructors & used lists belong to tier 0
+                continue;
+            }
+            if (global.isDeclaration()) continue;
+            global.setComdat(nullptr);
+            // Constants stay foldable; variables are the ones tier 0 defined
+            if (global.isConstant()) {
+                global.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+            } else {
+                global.setInitializer(nullptr);
+                global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+            global.setDSOLocal(false);
+        }
+        module.getFunction(function.name)->setName(function.name + TIER1_SUFFIX);
+
+        auto lease = compiler::TargetRegistry::instance().acquire(target);
+        if (!lease) return llvm::createStringError(llvm::inconvertibleErrorCode(), "no target machine for " + target.triple);
+        compiler::optimizeModule(module, lease.get(), "3");
+        if (auto error = jit.addObjectFile(compiler::emitObjectBuffer(module, lease.get(), "3"))) return error;
+
+        auto body = jit.lookup(function.name + TIER1_SUFFIX);
+        if (!body) return body.takeError();
+        if (auto error = stubs->updatePointer(function.name, *body)) return error;
+        if (verbose) std::cerr << "Tier 1: " << function.name << std::endl;
+        return llvm::Error::success();
+    }
+
+    llvm::orc::LLJIT& jit;
+    compiler::TargetKey target; // The host, as the JIT sees it
+    unsigned threshold;
+    bool verbose;
+    std::unique_ptr<llvm::orc::IndirectStubsManager> stubs;
+
+    std::vector<std::string> pristine;       // Bitcode of every module before instrumentation
+    std::vector<TieredFunction> functions;   // Indexed by the id the hook gets
+
+    std::mutex mutex; // Protects hot & stopping
+    std::condition_variable wake;
+    std::deque<size_t> hot;
+    bool stopping = false;
+    std::thread worker;
+};
+
+/**
+ * @class ReloadableProgram
+ * @brief The modules of a `gigly run --hot-reload` program and the thread that reloads them.
+ *
+ * Every function `f` the .gc modules define is called through an indirect
+ * stub named `f`, pointing at the body of its latest version, `f$vN`. When
+ * the reload function returns a rebuilt program, only the functions whose IR
+ * changed (or that are new) keep their bodies; everything else becomes a
+ * declaration, resolved against the stubs & globals already loaded. Global
+ * variables keep the definitions of the version that introduced them and the
+ * static constructors do not run again, so the program's state survives.
+ * Calls in progress finish in the old body; changing the layout of data the
+ * program already holds is not supported.
+ */
+class ReloadableProgram {
+  public:
+    ReloadableProgram(llvm::orc::LLJIT& jit, ReloadFn reload, bool verbose)
+        : jit(jit), reload(std::move(reload)), verbose(verbose), stubs(llvm::orc::createLocalIndirectStubsManagerBuilder(jit.getTargetTriple())()) {}
+    ReloadableProgram(const ReloadableProgram&) = delete;
+    ReloadableProgram& operator=(const ReloadableProgram&) = delete;
+    ~ReloadableProgram() { stop(); }
+
+    /**
+     * @brief Adds a module of the current version; its functions are pointed at once publish() runs.
+     */
+    llvm::Error add(llvm::orc::ThreadSafeModule module) {
+        bool changed = false;
+        module.withModuleDo([this, &changed](llvm::Module& m) { changed = prepare(m); });
+        if (!changed) return llvm::Error::success();
+        return jit.addIRModule(std::move(module));
+    }
+
+    /**
+     * @brief Points every stub at its first body and starts watching for changes.
+     */
+    llvm::Error start() {
+        if (!stubs) return llvm::createStringError(llvm::inconvertibleErrorCode(), "indirect stubs are not supported on " + jit.getTargetTriple().str());
+        if (auto error = publish()) return error;
+        worker = std::thread([this]() { work(); });
+        return llvm::Error::success();
+    }
+
+    /**
+     * @brief Stops watching; a reload in progress is finished first.
+     */
+    void stop() {
+        stopping = true;
+        if (worker.joinable()) worker.join();
+    }
+
+  private:
+    // Strips what the loaded versions already define; false if nothing is left to lower
+    bool prepare(llvm::Module& module) {
+        std::string version = VERSION_SUFFIX + std::to_string(generation);
+        bool changed = false;
+
+        // Hashed before locals are renamed per module, so an unchanged function hashes the same
+        std::vector<llvm::Function*> reloadable;
+        for (auto& function : module) {
+            if (function.isDeclaration() || function.hasLocalLinkage()) continue;
+            std::string name = function.getName().str();
+            // `main` runs once and linkonce & weak functions may be defined by several modules
+            if (name == "main" || !function.hasExternalLinkage()) {
+                if (defined.insert(name).second) {
+                    changed = true;
+                } else {
+                    function.deleteBody();
+                    function.setComdat(nullptr);
+                }
+                continue;
+            }
+            std::string text;
+            llvm::raw_string_ostream stream(text);
+            function.print(stream);
+            size_t hash = std::hash<std::string>{}(stream.str());
+            auto [known, added] = hashes.try_emplace(name, hash);
+            if (!added && known->second == hash) {
+                function.deleteBody();
+                function.setComdat(nullptr);
+                continue;
+            }
+            known->second = hash;
+            reloadable.push_back(&function);
+        }
+
+        for (auto& global : llvm::make_early_inc_range(module.globals())) {
+            if (global.getName().starts_with("llvm.")) {
+                // Constructors & used lists belong to the first version
+                if (generation > 0) global.eraseFromParent();
+                continue;
+            }
+            // Locals are renamed per module below, so they are always defined anew
+            if (global.isDeclaration() || global.hasLocalLinkage()) continue;
+            if (defined.insert(global.getName().str()).second) {
+                changed = true;
+                continue;
+            }
+            // Keeps the value the running program gave it
+            global.setInitializer(nullptr);
+            global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            global.setComdat(nullptr);
+            global.setDSOLocal(false);
+        }
+
+        // A version lives in modules of its own, so nothing may stay module-local
+        size_t index = modules++;
+        for (auto& global : module.global_values()) {
+            if (!global.hasLocalLinkage()) continue;
+            global.setName((global.hasName() ? global.getName().str() : "__gigly_anon") + ".m" + std::to_string(index));
+            global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            global.setVisibility(llvm::GlobalValue::DefaultVisibility);
+            global.setDSOLocal(false);
+        }
+
+        for (auto* function : reloadable) {
+            std::string name = function->getName().str();
+            function->setName(name + version);
+            // Callers, including this body, go through the stub
+            auto* stub = llvm::Function::Create(function->getFunctionType(), llvm::GlobalValue::ExternalLinkage, name, module);
+            stub->setCallingConv(function->getCallingConv());
+            stub->setAttributes(function->getAttributes());
+            function->replaceAllUsesWith(stub);
+            pending.push_back(name);
+            changed = true;
+        }
+        return changed;
+    }
+
+    // Creates the stubs of new functions and points the stubs of every added body at it
+    llvm::Error publish() {
+        std::string version = VERSION_SUFFIX + std::to_string(generation);
+        llvm::orc::SymbolMap symbols;
+        for (const auto& name : pending) {
+            if (stubs->findStub(name, true).getAddress()) continue;
+            if (auto error = stubs->createStub(name, llvm::orc::ExecutorAddr(), llvm::JITSymbolFlags::Exported)) return error;
+            symbols[jit.mangleAndIntern(name)] = {stubs->findStub(name, true).getAddress(), llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+        }
+        if (!symbols.empty()) {
+            if (auto error = jit.getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(symbols)))) return error;
+        }
+
+        // Lowers the version, now that the stubs it calls exist
+        for (const auto& name : pending) {
+            auto body = jit.lookup(name + version);
+            if (!body) return body.takeError();
+            if (auto error = stubs->updatePointer(name, *body)) return error;
+            if (verbose && generation > 0) std::cerr << "Reloaded: " << name << std::endl;
+        }
+        size_t count = pending.size();
+        pending.clear();
+        if (generation > 0) std::cerr << "Hot reload: " << count << " function(s) updated" << std::endl;
+        return llvm::Error::success();
+    }
+
+    void work() {
+        while (!stopping) {
+            auto rebuilt = reload();
+            if (rebuilt.empty()) continue;
+            timeTrace::Scope trace("Hot reload", std::to_string(generation + 1));
+            generation++;
+            llvm::Error error = llvm::Error::success();
+            for (auto& [context, module] : rebuilt) {
+                module->setDataLayout(jit.getDataLayout());
+                if ((error = add(llvm::orc::ThreadSafeModule(std::move(module), std::move(context))))) break;
+            }
+            if (!error) error = publish();
+            if (error) {
+                pending.clear();
+                std::cerr << "Warning: could not reload the program: " << llvm::toString(std::move(error)) << std::endl;
+            }
+        }
+    }
+
+    llvm::orc::LLJIT& jit;
+    ReloadFn reload;
+    bool verbose;
+    std::unique_ptr<llvm::orc::IndirectStubsManager> stubs;
+
+    // Touched by the worker only, once start() has run
+    size_t generation = 0;                           // Version being loaded; 0 is the one the program started with
+    size_t modules = 0;                              // Modules loaded so far, to keep renamed locals unique
+    std::unordered_map<std::string, size_t> hashes;  // Reloadable function -> hash of its loaded IR
+    std::unordered_set<std::string> defined;         // Other functions & globals some version defines
+    std::vector<std::string> pending;                // Functions added since the last publish()
+
+    std::atomic<bool> stopping = false;
+    std::thread worker;
+};
+
+} // namespace
+
+static bool runLazy(RunOptions& options, int& exitCode, llvm::raw_ostream& diagnostics) {
+    auto fail = [&diagnostics](llvm::Error error) {
+        diagnostics << llvm::toString(std::move(error)) << "\n";
+        return false;
+    };
+
+    auto jit = llvm::orc::LLLazyJITBuilder().create();
+    if (!jit) return fail(jit.takeError());
+    if (auto error = addProcessSymbols(**jit)) return fail(std::move(error));
+
+    {
+        timeTrace::Scope trace("JIT modules");
+        auto modules = collectModules(options, (*jit)->getDataLayout());
+        if (!modules) return fail(modules.takeError());
+        for (auto& module : *modules) {
+            if (auto error = (*jit)->addLazyIRModule(std::move(module))) return fail(std::move(error));
+        }
+    }
+
+    if (auto error = runMain(**jit, options, exitCode)) return fail(std::move(error));
+    return true;
+}
+
+static bool runTiered(RunOptions& options, int& exitCode, llvm::raw_ostream& diagnostics) {
+    auto fail = [&diagnostics](llvm::Error error) {
+        diagnostics << llvm::toString(std::move(error)) << "\n";
+        return false;
+    };
+
+    // Tier 0 is about start-up, so the JIT itself lowers without optimizing
+    auto host = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!host) return fail(host.takeError());
+    compiler::TargetKey target{host->getTargetTriple().str(), host->getCPU(), host->getFeatures().getString()};
+    host->setCodeGenOptLevel(llvm::CodeGenOptLevel::None);
+    auto jit = llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*host)).create();
+    if (!jit) return fail(jit.takeError());
+    if (auto error = addProcessSymbols(**jit)) return fail(std::move(error));
+
+    TieredProgram program(**jit, std::move(target), options.tierThreshold, options.verbose);
+    {
+        timeTrace::Scope trace("JIT modules");
+        auto modules = collectModules(options, (*jit)->getDataLayout());
+        if (!modules) return fail(modules.takeError());
+        for (auto& module : *modules) {
+            if (auto error = program.add(std::move(module))) return fail(std::move(error));
+        }
+        if (auto error = program.start()) return fail(std::move(error));
+    }
+
+    auto error = runMain(**jit, options, exitCode);
+    program.stop();
+    if (error) return fail(std::move(error));
+    return true;
+}
+
+static bool runHotReload(RunOptions& options, int& exitCode, llvm::raw_ostream& diagnostics) {
+    auto fail = [&diagnostics](llvm::Error error) {
+        diagnostics << llvm::toString(std::move(error)) << "\n";
+        return false;
+    };
+
+    auto jit = llvm::orc::LLJITBuilder().create();
+    if (!jit) return fail(jit.takeError());
+    if (auto error = addProcessSymbols(**jit)) return fail(std::move(error));
+
+    ReloadableProgram program(**jit, options.reload, options.verbose);
+    {
+        timeTrace::Scope trace("JIT modules");
+        // collectModules puts the .gc modules first; C & Rust bitcode is loaded once
+        size_t reloadable = options.modules.size();
+        auto modules = collectModules(options, (*jit)->getDataLayout());
+        if (!modules) return fail(modules.takeError());
+        for (size_t idx = 0; idx < modules->size(); ++idx) {
+            auto& module = (*modules)[idx];
+            if (auto error = idx < reloadable ? program.add(std::move(module)) : (*jit)->addIRModule(std::move(module))) return fail(std::move(error));
+        }
+        if (auto error = program.start()) return fail(std::move(error));
+    }
+
+    auto error = runMain(**jit, options, exitCode);
+    program.stop();
+    if (error) return fail(std::move(error));
+    return true;
+}
+
+Session::Session(std::unique_ptr<llvm::orc::LLJIT> jit) : jit(std::move(jit)) {}
+
+Session::~Session() = default;
+
+std::unique_ptr<Session> Session::create(std::string& diagnostics) {
+    compiler::TargetRegistry::initializeTargets();
+    auto jit = llvm::orc::LLJITBuilder().create();
+    if (!jit) {
+        diagnostics = llvm::toString(jit.takeError());
+        return nullptr;
+    }
+    if (auto error = addProcessSymbols(**jit)) {
+        diagnostics = llvm::toString(std::move(error));
+        return nullptr;
+    }
+    return std::unique_ptr<Session>(new Session(std::move(*jit)));
+}
+
+bool Session::add(JITModule module, std::string& diagnostics) {
+    module.module->setDataLayout(jit->getDataLayout());
+    if (auto error = jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module.module), std::move(module.context)))) {
+        diagnostics = llvm::toString(std::move(error));
+        return false;
+    }
+    return true;
+}
+
+void* Session::lookup(const std::string& name, std::string& diagnostics) {
+    auto address = jit->lookup(name);
+    if (!address) {
+        diagnostics = llvm::toString(address.takeError());
+        return nullptr;
+    }
+    return address->toPtr<void*>();
+}
+
+bool run(RunOptions& options, int& exitCode, std::string& diagnostics) {
+    llvm::raw_string_ostream diagnostics_stream(diagnostics);
+    compiler::TargetRegistry::initializeTargets();
+    if (options.reload) return runHotReload(options, exitCode, diagnostics_stream);
+    return options.tierThreshold > 0 ? runTiered(options, exitCode, diagnostics_stream) : runLazy(options, exitCode, diagnostics_stream);
+}
+
+} // namespace jit
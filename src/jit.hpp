@@ -0,0 +1,113 @@
+#ifndef JIT_HPP
+#define JIT_HPP
+
+/**
+ * @file jit.hpp
+ * @brief Runs a project in-process on ORC, for `gigly run`.
+ *
+ * The modules are handed to an LLLazyJIT, whose CompileOnDemandLayer splits
+ * them per function and lowers a function the first time it is called, so a
+ * program starts without writing, linking or even lowering most of its code.
+ * Symbols the modules do not define (libc, the C std library declarations)
+ * resolve against the gigly process itself.
+ *
+ * With a tier threshold the program runs tiered instead: everything is
+ * lowered quickly at -O0 with call & loop counters, and functions that get
+ * hot are re-optimized at -O3 on a background thread and swapped in through
+ * indirect stubs.
+ *
+ * With a reload function the program runs hot-reloadable: its .gc functions
+ * are also called through indirect stubs, and when the sources change the
+ * functions whose code changed are lowered again and swapped in while the
+ * program keeps running on the same globals and heap.
+ */
+
+#include <filesystem>
+#include <functional>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm::orc {
+class LLJIT;
+} // namespace llvm::orc
+
+namespace jit {
+
+/**
+ * @struct JITModule
+ * @brief A compiled module together with the context it lives in.
+ */
+struct JITModule {
+    std::unique_ptr<llvm::LLVMContext> context;
+    std::unique_ptr<llvm::Module> module;
+};
+
+/**
+ * @brief Polled by `gigly run --hot-reload` from a background thread.
+ *
+ * Waits a short while for the sources to change and returns the .gc modules
+ * of the rebuilt program if they did; an empty result means nothing to reload.
+ */
+using ReloadFn = std::function<std::vector<JITModule>()>;
+
+/**
+ * @struct RunOptions
+ * @brief What to run and with which arguments.
+ */
+struct RunOptions {
+    std::vector<JITModule> modules;              ///< The .gc modules, compiled in memory
+    std::vector<std::filesystem::path> bitcode;  ///< Bitcode of the C and Rust files
+    std::string programName;                     ///< argv[0] of the program
+    std::vector<std::string> args;               ///< Arguments after argv[0]
+    unsigned tierThreshold = 0;                  ///< Calls + loop iterations before a function is re-optimized; 0 = not tiered
+    ReloadFn reload;                             ///< Set to hot-reload the .gc functions; excludes tierThreshold
+    bool verbose = false;                        ///< Report functions as they are re-optimized or reloaded
+};
+
+/**
+ * @brief Adds every module to the JIT, runs the static constructors and calls `main`.
+ *
+ * @param options The modules & arguments; the modules are consumed.
+ * @param exitCode Receives the value `main` returned.
+ * @param diagnostics Receives the error message on failure.
+ * @return false if the program could not be started.
+ */
+bool run(RunOptions& options, int& exitCode, std::string& diagnostics);
+
+/**
+ * @class Session
+ * @brief A JIT that grows one module at a time, for `gigly repl`.
+ *
+ * Later modules resolve what they declare against the earlier ones, then
+ * against the gigly process.
+ */
+class Session {
+  public:
+    /**
+     * @return The session, or null with `diagnostics` set if the JIT could not be created.
+     */
+    static std::unique_ptr<Session> create(std::string& diagnostics);
+    ~Session();
+
+    /**
+     * @brief Adds a module; it is lowered once one of its symbols is looked up.
+     */
+    bool add(JITModule module, std::string& diagnostics);
+
+    /**
+     * @brief Address of a symbol, lowering the module that defines it.
+     * @return null with `diagnostics` set if nothing defines it.
+     */
+    void* lookup(const std::string& name, std::string& diagnostics);
+
+  private:
+    explicit Session(std::unique_ptr<llvm::orc::LLJIT> jit);
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+};
+
+} // namespace jit
+
+#endif // JIT_HPP
@@ -0,0 +1,80 @@
+#include "jobserver.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <unistd.h>
+
+namespace buildGraph {
+
+Jobserver::~Jobserver() {
+    if (owned_fd >= 0) close(owned_fd);
+}
+
+Jobserver* Jobserver::instance() {
+    static std::once_flag connected;
+    static Jobserver* jobserver = nullptr;
+    std::call_once(connected, []() {
+        const char* makeflags = std::getenv("MAKEFLAGS");
+        if (makeflags) jobserver = connect(makeflags);
+    });
+    return jobserver;
+}
+
+Jobserver* Jobserver::connect(const std::string& makeflags) {
+    // The last announcement wins; make appends the one of the innermost make
+    std::string auth;
+    std::istringstream words(makeflags);
+    for (std::string word; words >> word;) {
+        for (const char* prefix : {"--jobserver-auth=", "--jobserver-fds="}) {
+            if (word.rfind(prefix, 0) == 0) auth = word.substr(std::string(prefix).size());
+        }
+    }
+    if (auth.empty()) return nullptr;
+
+    if (auth.rfind("fifo:", 0) == 0) {
+        int fd = open(auth.substr(5).c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "Warning: jobserver fifo " << auth.substr(5) << " is not available; using -j as given." << std::endl;
+            return nullptr;
+        }
+        return new Jobserver(fd, fd, fd);
+    }
+
+    int read_fd = -1;
+    int write_fd = -1;
+    char comma = 0;
+    std::istringstream fds(auth);
+    if (!(fds >> read_fd >> comma >> write_fd) || comma != ',' || read_fd < 0 || write_fd < 0) return nullptr;
+    // make only passes the pipe to recipes it knows run make ('+' or $(MAKE))
+    if (fcntl(read_fd, F_GETFD) < 0 || fcntl(write_fd, F_GETFD) < 0) {
+        std::cerr << "Warning: the jobserver pipe of make is closed (mark the recipe with '+'); using -j as given." << std::endl;
+        return nullptr;
+    }
+    // Reopened through /proc, the pipe gets a file description of its own that
+    // can be non-blocking without changing it for make & the other jobs
+    int private_fd = open(("/proc/self/fd/" + std::to_string(read_fd)).c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (private_fd >= 0) return new Jobserver(private_fd, write_fd, private_fd);
+    return new Jobserver(read_fd, write_fd, -1);
+}
+
+std::optional<char> Jobserver::acquire(std::chrono::milliseconds timeout) {
+    pollfd request{read_fd, POLLIN, 0};
+    int ready = poll(&request, 1, static_cast<int>(timeout.count()));
+    if (ready <= 0) return std::nullopt;
+    // Another job may take the token between the poll & the read; the
+    // descriptor is non-blocking (when it could be reopened), so that is just a miss
+    char token = 0;
+    if (read(read_fd, &token, 1) != 1) return std::nullopt;
+    return token;
+}
+
+void Jobserver::release(char token) {
+    while (write(write_fd, &token, 1) < 0 && errno == EINTR) {}
+}
+
+} // namespace buildGraph
@@ -0,0 +1,63 @@
+#ifndef JOBSERVER_HPP
+#define JOBSERVER_HPP
+
+/**
+ * @file jobserver.hpp
+ * @brief Client of the GNU make jobserver, so `gigly` run from make shares its `-j` budget.
+ *
+ * make hands every recipe one implicit job slot; further slots are tokens,
+ * single bytes read from a pipe (or named fifo) shared by the whole build and
+ * written back when the job is done. The pipe is announced in MAKEFLAGS as
+ * `--jobserver-auth=R,W` (`--jobserver-fds=` before make 4.2) or
+ * `--jobserver-auth=fifo:PATH` (make 4.4).
+ */
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+namespace buildGraph {
+
+/**
+ * @class Jobserver
+ * @brief The jobserver of the make that started gigly, if there is one.
+ */
+class Jobserver {
+  public:
+    Jobserver(const Jobserver&) = delete;
+    Jobserver& operator=(const Jobserver&) = delete;
+    ~Jobserver();
+
+    /**
+     * @brief The jobserver announced in MAKEFLAGS, connected on first use.
+     * @return null if gigly was not started by a make with a jobserver, or its pipe is not open.
+     */
+    static Jobserver* instance();
+
+    /**
+     * @brief Takes a token, waiting at most `timeout` for one.
+     * @return The token, which must be handed to release(); nothing if none came.
+     */
+    std::optional<char> acquire(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Gives a token back to make.
+     */
+    void release(char token);
+
+  private:
+    Jobserver(int read_fd, int write_fd, int owned_fd) : read_fd(read_fd), write_fd(write_fd), owned_fd(owned_fd) {}
+
+    /**
+     * @brief Connects to the jobserver described by MAKEFLAGS.
+     */
+    static Jobserver* connect(const std::string& makeflags);
+
+    int read_fd;
+    int write_fd;
+    int owned_fd; ///< Descriptor opened here, closed with the client; -1 if none
+};
+
+} // namespace buildGraph
+
+#endif // JOBSERVER_HPP
@@ -2,8 +2,48 @@
 #include "../errors/errors.hpp"
 #include "token.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
 
+namespace {
+
+// Classes of a byte, combined as flags
+enum CharClass : uint8_t {
+    SPACE = 1 << 0,  // ' ', '\t', '\n' & '\r'
+    LETTER = 1 << 1, // a-z, A-Z & '_', which start an identifier
+    DIGIT = 1 << 2,  // 0-9
+    HEX = 1 << 3,    // 0-9, a-f & A-F
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses() {
+    std::array<uint8_t, 256> classes{};
+    for (char c : {' ', '\t', '\n', '\r'}) classes[static_cast<unsigned char>(c)] |= SPACE;
+    for (int c = 'a'; c <= 'z'; ++c) classes[c] |= LETTER;
+    for (int c = 'A'; c <= 'Z'; ++c) classes[c] |= LETTER;
+    classes['_'] |= LETTER;
+    for (int c = '0'; c <= '9'; ++c) classes[c] |= DIGIT | HEX;
+    for (int c = 'a'; c <= 'f'; ++c) classes[c] |= HEX;
+    for (int c = 'A'; c <= 'F'; ++c) classes[c] |= HEX;
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = makeCharClasses();
+
+inline bool isClass(char c, uint8_t classes) {
+    return CHAR_CLASSES[static_cast<unsigned char>(c)] & classes;
+}
+
+int hexValue(char c) {
+    if (c <= '9') return c - '0';
+    return (c | 0x20) - 'a' + 10; // 0x20 lowers the case of a letter
+}
+
+} // namespace
+
 Lexer::Lexer(const std::string& source, const std::filesystem::path& file_path, bool tokenize_coment) : tokenBuffer() {
     this->source = source;
     this->file_path = file_path;
@@ -12,79 +52,83 @@ Lexer::Lexer(const std::string& source, const std::filesystem::path& file_path,
     pos = -1;
     line_no = 1;
     col_no = -1;
-    current_char = "";
+    current_char = '\0';
     _readChar();
 }
 
-token::TokenType Lexer::_lookupIdent(const std::string ident) {
-    if (ident == "and") {
-        return token::TokenType::And;
-    } else if (ident == "or") {
-        return token::TokenType::Or;
-    } else if (ident == "not") {
-        return token::TokenType::Not;
-    } else if (ident == "def") {
-        return token::TokenType::Def;
-    } else if (ident == "return") {
-        return token::TokenType::Return;
-    } else if (ident == "if") {
-        return token::TokenType::If;
-    } else if (ident == "else") {
-        return token::TokenType::Else;
-    } else if (ident == "elif") {
-        return token::TokenType::ElIf;
-    } else if (ident == "is") {
-        return token::TokenType::Is;
-    } else if (ident == "while") {
-        return token::TokenType::While;
-    } else if (ident == "for") {
-        return token::TokenType::For;
-    } else if (ident == "in") {
-        return token::TokenType::In;
-    } else if (ident == "break") {
-        return token::TokenType::Break;
-    } else if (ident == "continue") {
-        return token::TokenType::Continue;
-    } else if (ident == "struct") {
-        return token::TokenType::Struct;
-    } else if (ident == "enum") {
-        return token::TokenType::Enum;
-    } else if (ident == "volatile") {
-        return token::TokenType::Volatile;
-    } else if (ident == "const") {
-        return token::TokenType::Const;
-    } else if (ident == "use") {
-        return token::TokenType::Use;
-    } else if (ident == "import") {
-        return token::TokenType::Import;
-    } else if (ident == "as") {
-        return token::TokenType::As;
-    } else if (ident == "True") {
-        return token::TokenType::True;
-    } else if (ident == "False") {
-        return token::TokenType::False;
-        // } else if(ident == "MayBe") {
-        //     return token::TokenType::Maybe;
-    } else if (ident == "None") {
-        return token::TokenType::None;
-    } else if (ident == "new") {
-        return token::TokenType::New;
-    } else if (ident == "try") {
-        return token::TokenType::Try;
-    } else if (ident == "catch") {
-        return token::TokenType::Catch;
-    } else if (ident == "raise") {
-        return token::TokenType::Raise;
-    } else if (ident == "notbreak") {
-        return token::TokenType::NotBreak;
-    } else if (ident == "ifbreak") {
-        return token::TokenType::IfBreak;
-    } else if (ident == "switch") {
-        return token::TokenType::Switch;
-    } else if (ident == "case") {
-        return token::TokenType::Case;
-    } else if (ident == "other") {
-        return token::TokenType::Other;
+token::TokenType Lexer::_lookupIdent(std::string_view ident) {
+    // Only the keywords starting with the same letter are compared
+    switch (ident[0]) {
+        case 'F':
+            if (ident == "False") return token::TokenType::False;
+            break;
+        case 'N':
+            if (ident == "None") return token::TokenType::None;
+            break;
+        case 'T':
+            if (ident == "True") return token::TokenType::True;
+            break;
+        case 'a':
+            if (ident == "and") return token::TokenType::And;
+            if (ident == "as") return token::TokenType::As;
+            break;
+        case 'b':
+            if (ident == "break") return token::TokenType::Break;
+            break;
+        case 'c':
+            if (ident == "continue") return token::TokenType::Continue;
+            if (ident == "const") return token::TokenType::Const;
+            if (ident == "catch") return token::TokenType::Catch;
+            if (ident == "case") return token::TokenType::Case;
+            break;
+        case 'd':
+            if (ident == "def") return token::TokenType::Def;
+            break;
+        case 'e':
+            if (ident == "else") return token::TokenType::Else;
+            if (ident == "elif") return token::TokenType::ElIf;
+            if (ident == "enum") return token::TokenType::Enum;
+            break;
+        case 'f':
+            if (ident == "for") return token::TokenType::For;
+            break;
+        case 'i':
+            if (ident == "if") return token::TokenType::If;
+            if (ident == "is") return token::TokenType::Is;
+            if (ident == "in") return token::TokenType::In;
+            if (ident == "import") return token::TokenType::Import;
+            if (ident == "ifbreak") return token::TokenType::IfBreak;
+            break;
+        case 'n':
+            if (ident == "not") return token::TokenType::Not;
+            if (ident == "new") return token::TokenType::New;
+            if (ident == "notbreak") return token::TokenType::NotBreak;
+            break;
+        case 'o':
+            if (ident == "or") return token::TokenType::Or;
+            if (ident == "other") return token::TokenType::Other;
+            break;
+        case 'r':
+            if (ident == "return") return token::TokenType::Return;
+            if (ident == "raise") return token::TokenType::Raise;
+            break;
+        case 's':
+            if (ident == "struct") return token::TokenType::Struct;
+            if (ident == "switch") return token::TokenType::Switch;
+            break;
+        case 't':
+            if (ident == "try") return token::TokenType::Try;
+            break;
+        case 'u':
+            if (ident == "use") return token::TokenType::Use;
+            break;
+        case 'v':
+            if (ident == "volatile") return token::TokenType::Volatile;
+            break;
+        case 'w':
+            if (ident == "while") return token::TokenType::While;
+            break;
+            // case 'M': `MayBe` -> token::TokenType::Maybe
     }
 
     return token::TokenType::Identifier;
@@ -97,262 +141,199 @@ token::Token Lexer::nextToken() {
         return token;
     }
 
-    token::Token token;
     this->_skipWhitespace();
 
-    if (this->current_char == "+") {
-        if (this->_peekChar() == "+") {
-            token = this->_newToken(token::TokenType::Increment, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '++'
-        } else if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::PlusEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '+='
-        } else {
-            token = this->_newToken(token::TokenType::Plus, this->current_char);
-        }
-    } else if (this->current_char == ".") {
-        if (this->_peekChar() == "." && this->_peekChar(2) == ".") {
-            token = this->_newToken(token::TokenType::Ellipsis, this->current_char + this->_peekChar() + this->_peekChar(2));
-            this->_readChar(); // Move to next character after '..'
-            this->_readChar(); // Move to next character after '...'
-        } else {
-            token = this->_newToken(token::TokenType::Dot, this->current_char);
-        }
-    } else if (this->current_char == "-") {
-        if (this->_peekChar() == ">") {
-            token = this->_newToken(token::TokenType::RightArrow, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '->'
-        } else if (this->_peekChar() == "-") {
-            token = this->_newToken(token::TokenType::Decrement, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '--'
-        } else if (this->_isDigit(this->_peekChar())) {
-            int st_col_no = this->col_no;
-            this->_readChar(); // Move to next character after '-'
-            token = this->_readNumber();
-            token.col_no = st_col_no;
-            token.literal = "-" + token.literal;
-            return token;
-        } else if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::DashEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '-='
-        } else {
-            token = this->_newToken(token::TokenType::Dash, this->current_char);
-        }
-    } else if (this->current_char == "*") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::AsteriskEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '*='
-        } else if (this->_peekChar() == "*") {
-            token = this->_newToken(token::TokenType::AsteriskAsterisk, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '**'
-        } else {
-            token = this->_newToken(token::TokenType::Asterisk, this->current_char);
-        }
-    } else if (this->current_char == "/") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::ForwardSlashEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '/='
-        } else {
-            token = this->_newToken(token::TokenType::ForwardSlash, this->current_char);
-        }
-    } else if (this->current_char == "%") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::PercentEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '%='
-        } else {
-            token = this->_newToken(token::TokenType::Percent, this->current_char);
-        }
-    } else if (this->current_char == "^") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::CaretEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '^='
-        } else {
-            token = this->_newToken(token::TokenType::BitwiseXor, this->current_char);
-        }
-    } else if (this->current_char == "=") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::EqualEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '=='
-        } else {
-            token = this->_newToken(token::TokenType::Equals, this->current_char);
-        }
-    } else if (this->current_char == ">") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::GreaterThanOrEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '>='
-        } else if (this->_peekChar() == ">") {
-            token = this->_newToken(token::TokenType::RightShift, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '>>'
-        } else {
-            token = this->_newToken(token::TokenType::GreaterThan, this->current_char);
-        }
-    } else if (this->current_char == "<") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::LessThanOrEqual, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '<='
-        } else if (this->_peekChar() == "<") {
-            token = this->_newToken(token::TokenType::LeftShift, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '<<'
-        } else {
-            token = this->_newToken(token::TokenType::LessThan, this->current_char);
-        }
-    } else if (this->current_char == "!") {
-        if (this->_peekChar() == "=") {
-            token = this->_newToken(token::TokenType::NotEquals, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '!='
-        } else {
-            token = this->_newToken(token::TokenType::Illegal, this->current_char);
-        }
-    } else if (this->current_char == "{") {
-        token = this->_newToken(token::TokenType::LeftBrace, this->current_char);
-    } else if (this->current_char == "}") {
-        token = this->_newToken(token::TokenType::RightBrace, this->current_char);
-    } else if (this->current_char == "(") {
-        token = this->_newToken(token::TokenType::LeftParen, this->current_char);
-    } else if (this->current_char == ")") {
-        token = this->_newToken(token::TokenType::RightParen, this->current_char);
-    } else if (this->current_char == "[") {
-        token = this->_newToken(token::TokenType::LeftBracket, this->current_char);
-    } else if (this->current_char == "]") {
-        token = this->_newToken(token::TokenType::RightBracket, this->current_char);
-    } else if (this->current_char == ":") {
-        token = this->_newToken(token::TokenType::Colon, this->current_char);
-    } else if (this->current_char == ";") {
-        token = this->_newToken(token::TokenType::Semicolon, this->current_char);
-    } else if (this->current_char == "&") {
-        if (this->_peekChar() == "&") {
-            token = this->_newToken(token::TokenType::BitwiseAnd, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '&&'
-        } else {
-            token = this->_newToken(token::TokenType::Refrence, this->current_char);
-        }
-    } else if (this->current_char == "|") {
-        if (this->_peekChar() == "|") {
-            token = this->_newToken(token::TokenType::BitwiseOr, this->current_char + this->_peekChar());
-            this->_readChar(); // Move to next character after '||'
-        } else {
-            token = this->_newToken(token::TokenType::Pipe, this->current_char);
-        }
-    } else if (this->current_char == "~") {
-        token = this->_newToken(token::TokenType::BitwiseNot, this->current_char);
-    } else if (this->current_char == ",") {
-        token = this->_newToken(token::TokenType::Comma, this->current_char);
-    } else if (this->current_char == "@") {
-        token = this->_newToken(token::TokenType::AtTheRate, this->current_char);
-    } else if (this->current_char == "") {
-        token = this->_newToken(token::TokenType::EndOfFile, "");
-    } else if (this->current_char == "#" && tokenize_coment) {
-        int st_col = this->col_no;
-        this->_readChar();
-        std::string literal = "#";
-        while (this->current_char != "\n" && this->current_char != "") {
-            this->_readChar();
-            literal += this->current_char;
-        }
-        return token::Token(token::TokenType::Coment, literal, line_no, line_no, st_col, this->col_no);
-    } else {
-        if (this->_isString() != "") {
-            auto quote = this->_isString();
+    switch (this->current_char) {
+        case '+':
+            if (this->_peekChar() == '+') return this->_operatorToken(token::TokenType::Increment, 2);
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::PlusEqual, 2);
+            return this->_operatorToken(token::TokenType::Plus, 1);
+        case '.':
+            if (this->_peekChar() == '.' && this->_peekChar(2) == '.') return this->_operatorToken(token::TokenType::Ellipsis, 3);
+            return this->_operatorToken(token::TokenType::Dot, 1);
+        case '-':
+            if (this->_peekChar() == '>') {
+                return this->_operatorToken(token::TokenType::RightArrow, 2);
+            } else if (this->_peekChar() == '-') {
+                return this->_operatorToken(token::TokenType::Decrement, 2);
+            } else if (isClass(this->_peekChar(), DIGIT)) {
+                int st_col_no = this->col_no;
+                this->_readChar(); // Move to next character after '-'
+                auto token = this->_readNumber();
+                token.col_no = st_col_no;
+                token.literal.insert(0, 1, '-');
+                return token;
+            } else if (this->_peekChar() == '=') {
+                return this->_operatorToken(token::TokenType::DashEqual, 2);
+            } else {
+                return this->_operatorToken(token::TokenType::Dash, 1);
+            }
+        case '*':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::AsteriskEqual, 2);
+            if (this->_peekChar() == '*') return this->_operatorToken(token::TokenType::AsteriskAsterisk, 2);
+            return this->_operatorToken(token::TokenType::Asterisk, 1);
+        case '/':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::ForwardSlashEqual, 2);
+            return this->_operatorToken(token::TokenType::ForwardSlash, 1);
+        case '%':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::PercentEqual, 2);
+            return this->_operatorToken(token::TokenType::Percent, 1);
+        case '^':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::CaretEqual, 2);
+            return this->_operatorToken(token::TokenType::BitwiseXor, 1);
+        case '=':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::EqualEqual, 2);
+            return this->_operatorToken(token::TokenType::Equals, 1);
+        case '>':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::GreaterThanOrEqual, 2);
+            if (this->_peekChar() == '>') return this->_operatorToken(token::TokenType::RightShift, 2);
+            return this->_operatorToken(token::TokenType::GreaterThan, 1);
+        case '<':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::LessThanOrEqual, 2);
+            if (this->_peekChar() == '<') return this->_operatorToken(token::TokenType::LeftShift, 2);
+            return this->_operatorToken(token::TokenType::LessThan, 1);
+        case '!':
+            if (this->_peekChar() == '=') return this->_operatorToken(token::TokenType::NotEquals, 2);
+            return this->_operatorToken(token::TokenType::Illegal, 1);
+        case '&':
+            if (this->_peekChar() == '&') return this->_operatorToken(token::TokenType::BitwiseAnd, 2);
+            return this->_operatorToken(token::TokenType::Refrence, 1);
+        case '|':
+            if (this->_peekChar() == '|') return this->_operatorToken(token::TokenType::BitwiseOr, 2);
+            return this->_operatorToken(token::TokenType::Pipe, 1);
+        case '{': return this->_operatorToken(token::TokenType::LeftBrace, 1);
+        case '}': return this->_operatorToken(token::TokenType::RightBrace, 1);
+        case '(': return this->_operatorToken(token::TokenType::LeftParen, 1);
+        case ')': return this->_operatorToken(token::TokenType::RightParen, 1);
+        case '[': return this->_operatorToken(token::TokenType::LeftBracket, 1);
+        case ']': return this->_operatorToken(token::TokenType::RightBracket, 1);
+        case ':': return this->_operatorToken(token::TokenType::Colon, 1);
+        case ';': return this->_operatorToken(token::TokenType::Semicolon, 1);
+        case '~': return this->_operatorToken(token::TokenType::BitwiseNot, 1);
+        case ',': return this->_operatorToken(token::TokenType::Comma, 1);
+        case '@': return this->_operatorToken(token::TokenType::AtTheRate, 1);
+        case '\0':
+            if (this->_atEnd()) {
+                auto token = this->_newToken(token::TokenType::EndOfFile, "");
+                this->_readChar(); // Reading on past the end still moves the column
+                return token;
+            }
+            return this->_operatorToken(token::TokenType::Illegal, 1);
+        case '#':
+            // Only reached when comments are tokens; otherwise _skipWhitespace skips them
+            if (this->tokenize_coment) return this->_readComent();
+            return this->_operatorToken(token::TokenType::Illegal, 1);
+        case '"':
+        case '\'': {
+            char quote = this->current_char;
+            bool triple = this->_peekChar(1) == quote && this->_peekChar(2) == quote;
             int st_col_no = this->col_no;
             int st_line_no = this->line_no;
-            std::string str = this->_readString(quote);
-            token = token::Token(token::TokenType::String, str, st_line_no, line_no, st_col_no, col_no);
-            return token;
-        } else if (this->_isLetter(this->current_char)) {
-            std::string ident = this->_readIdentifier();
-            token = this->_newToken(this->_lookupIdent(ident), ident);
-            return token;
-        } else if (this->_isDigit(this->current_char)) {
-            token = this->_readNumber();
-            return token;
-        } else {
-            token = this->_newToken(token::TokenType::Illegal, this->current_char);
+            std::string str = this->_readString(quote, triple);
+            return token::Token(token::TokenType::String, std::move(str), st_line_no, line_no, st_col_no, col_no);
         }
+        default:
+            if (isClass(this->current_char, LETTER)) {
+                std::string_view ident = this->_readIdentifier();
+                return this->_newToken(this->_lookupIdent(ident), ident);
+            }
+            if (isClass(this->current_char, DIGIT)) return this->_readNumber();
+            return this->_operatorToken(token::TokenType::Illegal, 1);
     }
-
-    this->_readChar(); // Move to next character after processing current token
-    return token;
 }
 
 void Lexer::_readChar() {
     this->pos++;
-    if (this->pos >= static_cast<int>(this->source.length())) {
-        // Set current_char to empty string to tell EOF
-        this->current_char = "";
-    } else {
-        this->current_char = this->source[this->pos];
-    }
+    // '\0' tells EOF
+    this->current_char = this->_atEnd() ? '\0' : this->source[this->pos];
     this->col_no++;
 }
 
-std::string Lexer::_peekChar(int offset) {
-    int peek_pos = this->pos + offset;
-    if (peek_pos >= static_cast<int>(this->source.length())) {
-        // Return an empty string to tell EOF
-        return "";
-    } else {
-        return std::string(1, source[peek_pos]);
-    }
+void Lexer::_advance(int count) {
+    this->pos += count;
+    this->current_char = this->_atEnd() ? '\0' : this->source[this->pos];
+    this->col_no += count;
+}
+
+char Lexer::_peekChar(int offset) const {
+    size_t peek_pos = static_cast<size_t>(this->pos) + offset;
+    // Return '\0' to tell EOF
+    return peek_pos < this->source.size() ? this->source[peek_pos] : '\0';
 }
 
-token::Token Lexer::_newToken(token::TokenType type, std::string currentChar) {
-    return token::Token(type, currentChar, line_no, line_no, col_no - currentChar.length(), col_no);
+bool Lexer::_atEnd() const {
+    return static_cast<size_t>(this->pos) >= this->source.size();
+}
+
+token::Token Lexer::_newToken(token::TokenType type, std::string_view literal) {
+    return token::Token(type, std::string(literal), line_no, line_no, col_no - static_cast<int>(literal.size()), col_no);
+}
+
+token::Token Lexer::_operatorToken(token::TokenType type, int length) {
+    // Columns are counted from the first byte, whatever the length
+    auto token = token::Token(type, std::string(this->source, this->pos, length), line_no, line_no, col_no - length, col_no);
+    this->_advance(length); // Move to next character after processing current token
+    return token;
 }
 
 token::Token Lexer::_readNumber() {
-    int dot_count = 0;
-    std::string number = "";
-    while (this->_isDigit(this->current_char) || this->current_char == ".") {
-        if (this->current_char == ".") {
-            dot_count++;
-            // Check for multiple dots in the number
-            if (dot_count > 1) {
-                printf("Invalid number at line %u, column %i\n", this->line_no, this->col_no);
-                return this->_newToken(token::TokenType::Illegal, this->current_char);
-            }
+    const char* begin = this->source.data() + this->pos;
+    const char* end = this->source.data() + this->source.size();
+    const char* cursor = begin;
+    bool dot = false;
+    for (; cursor < end && (isClass(*cursor, DIGIT) || *cursor == '.'); ++cursor) {
+        if (*cursor != '.') continue;
+        // Check for multiple dots in the number
+        if (dot) {
+            this->_advance(cursor - begin);
+            printf("Invalid number at line %u, column %i\n", this->line_no, this->col_no);
+            // The dot is lexed again as the next token
+            return this->_newToken(token::TokenType::Illegal, ".");
         }
-        number += this->current_char;
-        this->_readChar();
-        if (this->current_char == "") break;
+        dot = true;
     }
-    if (dot_count == 0) { return this->_newToken(token::TokenType::Integer, number); }
-    return this->_newToken(token::TokenType::Float, number);
+    this->_advance(cursor - begin);
+    return this->_newToken(dot ? token::TokenType::Float : token::TokenType::Integer, std::string_view(begin, cursor - begin));
 };
 
-std::string Lexer::_readIdentifier() {
-    std::string identifier = "";
-    while (this->_isLetter(this->current_char) || this->_isDigit(this->current_char)) {
-        identifier += this->current_char;
-        this->_readChar();
-    };
-    return identifier;
+std::string_view Lexer::_readIdentifier() {
+    const char* begin = this->source.data() + this->pos;
+    const char* end = this->source.data() + this->source.size();
+    const char* cursor = begin;
+    while (cursor < end && isClass(*cursor, LETTER | DIGIT)) ++cursor;
+    this->_advance(cursor - begin);
+    return std::string_view(begin, cursor - begin);
 }
 
 void Lexer::_skipWhitespace() {
-    // Skip whitespace characters
-    while (this->current_char == " " || this->current_char == "\t" || this->current_char == "\n" || this->current_char == "\r") {
-        if (this->current_char == "\n") {
-            this->line_no++;
-            this->col_no = 0;
+    // Most tokens follow one another directly
+    if (!isClass(this->current_char, SPACE) && this->current_char != '#') return;
+    const char* cursor = this->source.data() + this->pos;
+    const char* end = this->source.data() + this->source.size();
+    int col = this->col_no;
+    while (cursor < end) {
+        // Skip whitespace characters
+        if (isClass(*cursor, SPACE)) {
+            if (*cursor == '\n') {
+                this->line_no++;
+                col = 0;
+            }
+            ++cursor;
+            ++col;
+            continue;
         }
-        this->_readChar();
-    }
-    // Skip comments starting with #
-    if (this->current_char == "#" && !tokenize_coment) {
-        this->_readChar();
-        while (this->current_char != "\n" && this->current_char != "") { this->_readChar(); }
-        this->_skipWhitespace(); // Recursive call to also skip the white space
+        // Skip comments starting with #, up to the newline
+        if (*cursor != '#' || tokenize_coment) break;
+        auto newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        const char* stop = newline ? newline : end;
+        col += stop - cursor;
+        cursor = stop;
     }
+    this->pos = cursor - this->source.data();
+    this->col_no = col;
+    this->current_char = cursor < end ? *cursor : '\0';
 }
 
-bool Lexer::_isDigit(const std::string& character) {
-    return character >= "0" && character <= "9"; /* 0-9 in ansi is lied in one after the another*/
-};
-
-bool Lexer::_isLetter(const std::string& character) {
-    return (character >= "a" && character <= "z") || (character >= "A" && character <= "Z") || character == "_"; /* a-z & A-Z in ansi is lied in one after the another*/
-};
-
 std::string getStringOnLineNumber(const std::string& input_string, int line_number) {
     std::istringstream input(input_string);
     std::string line;
@@ -371,55 +352,57 @@ int getNumberOfLines(const std::string& str) {
     return std::count(str.begin(), str.end(), '\n') + 1;
 }
 
-std::string Lexer::_isString() {
-    // Check for double or single quotes to identify string literals
-    if (this->current_char == "\"") {
-        if (this->_peekChar(1) == "\"") {
-            if (this->_peekChar(2) == "\"") {
-                return "\"\"\"";
-            } else {
-                return "\"";
-            }
-        } else {
-            return "\"";
-        }
-    } else if (this->current_char == "'") {
-        if (this->_peekChar(1) == "'") {
-            if (this->_peekChar(2) == "'") {
-                return "'''";
-            } else {
-                return "'";
-            }
-        } else {
-            return "'";
-        }
-    }
-    return "";
+token::Token Lexer::_readComent() {
+    int st_col = this->col_no;
+    const char* begin = this->source.data() + this->pos;
+    const char* end = this->source.data() + this->source.size();
+    auto newline = static_cast<const char*>(std::memchr(begin + 1, '\n', end - begin - 1));
+    const char* stop = newline ? newline : end;
+    // The byte after '#' is left out of the literal and the ending newline is part of it
+    std::string literal = "#";
+    if (stop > begin + 1) literal.append(begin + 2, std::min(stop + 1, end));
+    this->_advance(stop - begin);
+    return token::Token(token::TokenType::Coment, std::move(literal), line_no, line_no, st_col, this->col_no);
 }
 
-std::string Lexer::_readString(const std::string& quote) {
+std::string Lexer::_readString(char quote, bool triple) {
     std::string str = "";
-    std::string literal = quote;
+    std::string literal(triple ? 3 : 1, quote);
     int st_col_no = this->col_no;
     // Handle triple quotes
-    if (quote == "\"\"\"" || quote == "'''") {
+    if (triple) {
         this->_readChar();
         this->_readChar();
     }
-    st_col_no = st_col_no - quote.length() - 1;
+    st_col_no = st_col_no - literal.length() - 1;
+    auto raiseInvalid = [&](const std::string& message, const std::string& suggestedFix) {
+        errors::raiseSyntaxError(this->file_path,
+                                 token::Token(token::TokenType::String, literal, this->line_no, this->line_no, st_col_no, this->col_no - 2),
+                                 this->source,
+                                 message,
+                                 suggestedFix);
+    };
+    const char* text = this->source.data();
+    const size_t length = this->source.size();
     while (true) {
         this->_readChar();
+        // Runs of plain bytes are copied at once
+        size_t run = this->pos;
+        while (run < length && text[run] != quote && text[run] != '\\' && text[run] != '\n') ++run;
+        if (run > static_cast<size_t>(this->pos)) {
+            str.append(text + this->pos, run - this->pos);
+            literal.append(text + this->pos, run - this->pos);
+            this->_advance(run - this->pos - 1);
+            continue;
+        }
+
         // Handle unterminated string literals
-        if ((this->current_char == "" || this->current_char == "\n") && (quote == "\"" || quote == "'") && !this->tokenize_coment) {
-            errors::raiseSyntaxError(this->file_path,
-                                     token::Token(token::TokenType::String, literal, this->line_no, this->line_no, st_col_no, this->col_no - 2),
-                                     this->source,
-                                     "Unterminated string literal",
-                                     "Add a closing " + quote + " to terminate the string literal");
-        } else if (this->current_char == "\\") {
+        if ((this->_atEnd() || this->current_char == '\n') && !triple && !this->tokenize_coment) {
+            raiseInvalid("Unterminated string literal", "Add a closing " + std::string(1, quote) + " to terminate the string literal");
+        } else if (this->current_char == '\\') {
             this->_readChar();
             // Handle escape sequences
-            switch (this->current_char[0]) {
+            switch (this->current_char) {
                 case '"':
                     str += "\"";
                     literal += "\\\"";
@@ -457,28 +440,15 @@ std::string Lexer::_readString(const std::string& quote) {
                     literal += "\\\\";
                     break;
                 case 'x': { // Hexadecimal escape sequence \xHH
-                    std::string hex_str = "";
-                    this->_readChar();
-                    if (!_isHexDigit(current_char)) {
-                        errors::raiseSyntaxError(this->file_path,
-                                                 token::Token(token::TokenType::String, literal, this->line_no, this->line_no, st_col_no, this->col_no - 2),
-                                                 this->source,
-                                                 "Invalid hexadecimal escape sequence",
-                                                 "Expected two hexadecimal digits after \\x");
-                    }
-                    hex_str += current_char;
-                    this->_readChar();
-                    if (!_isHexDigit(current_char)) {
-                        errors::raiseSyntaxError(this->file_path,
-                                                 token::Token(token::TokenType::String, literal, this->line_no, this->line_no, st_col_no, this->col_no - 2),
-                                                 this->source,
-                                                 "Invalid hexadecimal escape sequence",
-                                                 "Expected two hexadecimal digits after \\x");
+                    char hex_str[2];
+                    for (char& digit : hex_str) {
+                        this->_readChar();
+                        if (!isClass(this->current_char, HEX)) raiseInvalid("Invalid hexadecimal escape sequence", "Expected two hexadecimal digits after \\x");
+                        digit = this->current_char;
                     }
-                    hex_str += current_char;
-                    char char_val = static_cast<char>(std::stoul(hex_str, nullptr, 16));
-                    str += char_val;
-                    literal += "\\x" + hex_str;
+                    str += static_cast<char>(hexValue(hex_str[0]) * 16 + hexValue(hex_str[1]));
+                    literal += "\\x";
+                    literal.append(hex_str, 2);
                     break;
                 }
                 case 'u': // Unicode escape sequences (UTF-8 encoding) are more complex.
@@ -488,32 +458,36 @@ std::string Lexer::_readString(const std::string& quote) {
                     // dealt with, we treat these as literal characters for now
                     [[fallthrough]];
                 default: // If not a recognized escape sequence, treat literally.
-                    str += "\\" + this->current_char;
-                    literal += "\\" + this->current_char;
+                    str += '\\';
+                    literal += '\\';
+                    if (!this->_atEnd()) {
+                        str += this->current_char;
+                        literal += this->current_char;
+                    }
                     break;
             }
-        } else if ((this->current_char == quote)) {
-            this->_readChar();
-            break;
-        } else if (this->current_char + this->_peekChar() + this->_peekChar(2) == quote) {
-            this->_readChar();
-            this->_readChar();
-            this->_readChar();
-            break;
-        } else if (this->current_char == "") {
+        } else if (this->current_char == quote) {
+            if (!triple) {
+                this->_readChar();
+                break;
+            }
+            if (this->_peekChar() == quote && this->_peekChar(2) == quote) {
+                this->_readChar();
+                this->_readChar();
+                this->_readChar();
+                break;
+            }
+            // A lone quote inside a triple quoted string
+            str += quote;
+            literal += quote;
+        } else if (this->_atEnd()) {
             break;
-        } else if (this->current_char == "\n") {
-            str += this->current_char;
-            literal += this->current_char;
-            this->line_no++;
         } else {
+            // A newline; the column is not reset inside a string
             str += this->current_char;
             literal += this->current_char;
+            this->line_no++;
         }
     }
     return str;
 }
-
-bool Lexer::_isHexDigit(const std::string& character) {
-    return (character >= "0" && character <= "9") || (character >= "a" && character <= "f") || (character >= "A" && character <= "F");
-}
@@ -3,9 +3,11 @@
  * @brief This file contains the declaration of the Lexer class and related
  * functions.
  *
- * The Lexer class is responsible for tokenizing the source code. It reads the
- * source code character by character and generates tokens that represent the
- * different elements of the code.
+ * The Lexer class is responsible for tokenizing the source code. It walks the
+ * bytes of the source, classifying each with a 256-entry table, and generates
+ * tokens that represent the different elements of the code. Identifiers,
+ * numbers, whitespace and comments are scanned as runs, so a token's literal is
+ * built with a single copy out of the source.
  *
  * Functions:
  * - getStringOnLineNumber: Get the string on a specific line number from the
@@ -18,27 +20,29 @@
  *   - pos: The current position in the source code.
  *   - line_no: The current line number in the source code.
  *   - col_no: The current column number in the source code.
- *   - current_char: The current character being processed.
+ *   - current_char: The current byte being processed.
  * - Methods:
  *   - Lexer: Constructor to initialize the Lexer with the source code.
  *   - nextToken: Get the next token from the source code.
  *   - _lookupIdent: Lookup the identifier type.
- *   - _readChar: Read the next character from the source code.
- *   - _peekChar: Peek at the character at the specified offset.
+ *   - _readChar: Read the next byte from the source code.
+ *   - _advance: Move several bytes ahead, all on the current line.
+ *   - _peekChar: Peek at the byte at the specified offset.
+ *   - _atEnd: Check if the whole source has been read.
  *   - _skipWhitespace: Skip whitespace characters in the source code.
  *   - _newToken: Create a new token.
+ *   - _operatorToken: Create the token of an operator starting at the current byte.
  *   - _readNumber: Read a number from the source code.
- *   - _isDigit: Check if the character is a digit.
- *   - _isLetter: Check if the character is a letter.
- *   - _isString: Check if the current character is a string.
  *   - _readIdentifier: Read an identifier from the source code.
  *   - _readString: Read a string from the source code.
+ *   - _readComent: Read a comment token from the source code.
  */
 #ifndef LEXER_HPP
 #define LEXER_HPP
 #include "token.hpp"
 #include <filesystem>
 #include <stack>
+#include <string_view>
 #include <vector>
 
 /**
@@ -62,10 +66,10 @@ class Lexer {
   public:
     std::string source; ///< The source code to be lexed.
     std::filesystem::path file_path;
-    int pos;                  ///< The current position in the source code.
-    unsigned int line_no;     ///< The current line number in the source code.
-    int col_no;               ///< The current column number in the source code.
-    std::string current_char; ///< The current character being processed.
+    int pos;              ///< The current position in the source code.
+    unsigned int line_no; ///< The current line number in the source code.
+    int col_no;           ///< The current column number in the source code.
+    char current_char;    ///< The current byte; '\0' past the end of the source (a NUL inside it is lexed like any other byte).
     bool tokenize_coment;
     std::vector<token::Token> tokenBuffer;
 
@@ -90,79 +94,87 @@ class Lexer {
      * @param ident The identifier to lookup.
      * @return The token type of the identifier.
      */
-    token::TokenType _lookupIdent(const std::string ident);
+    token::TokenType _lookupIdent(std::string_view ident);
 
     /**
-     * @brief Read the next character from the source code.
+     * @brief Read the next byte from the source code.
      */
     void _readChar();
 
     /**
-     * @brief Peek at the character at the specified offset.
+     * @brief Move `count` bytes ahead; none of the skipped bytes may be a newline.
      *
-     * @param offset The offset to peek at.
-     * @return The character at the specified offset.
+     * @param count The number of bytes to move.
      */
-    std::string _peekChar(int offset = 1);
+    void _advance(int count);
 
     /**
-     * @brief Skip whitespace characters in the source code.
+     * @brief Peek at the byte at the specified offset.
+     *
+     * @param offset The offset to peek at.
+     * @return The byte at the specified offset, '\0' past the end of the source.
      */
-    void _skipWhitespace();
+    char _peekChar(int offset = 1) const;
 
     /**
-     * @brief Create a new token.
+     * @brief Check if the whole source has been read.
      *
-     * @param type The type of the token.
-     * @param current_char The current character being processed.
-     * @return The new token.
+     * @return True if the current position is past the end of the source.
      */
-    token::Token _newToken(token::TokenType type, std::string current_char);
+    bool _atEnd() const;
 
     /**
-     * @brief Read a number from the source code.
-     *
-     * @return The number token.
+     * @brief Skip whitespace characters in the source code.
      */
-    token::Token _readNumber();
+    void _skipWhitespace();
 
     /**
-     * @brief Check if the character is a digit.
+     * @brief Create a new token that ends at the current column.
      *
-     * @param character The character to check.
-     * @return True if the character is a digit, false otherwise.
+     * @param type The type of the token.
+     * @param literal The literal of the token.
+     * @return The new token.
      */
-    bool _isDigit(const std::string& character);
+    token::Token _newToken(token::TokenType type, std::string_view literal);
 
     /**
-     * @brief Check if the character is a letter.
+     * @brief Create the token of an operator starting at the current byte.
      *
-     * @param character The character to check.
-     * @return True if the character is a letter, false otherwise.
+     * Moves past the operator.
+     * @param type The type of the token.
+     * @param length The number of bytes of the operator.
+     * @return The operator token.
      */
-    bool _isLetter(const std::string& character);
+    token::Token _operatorToken(token::TokenType type, int length);
 
     /**
-     * @brief Check if the current character is a string.
+     * @brief Read a number from the source code.
      *
-     * @return The string if the current character is a string.
+     * @return The number token.
      */
-    std::string _isString();
+    token::Token _readNumber();
 
     /**
      * @brief Read an identifier from the source code.
      *
-     * @return The identifier.
+     * @return The identifier, a view into the source.
      */
-    std::string _readIdentifier();
+    std::string_view _readIdentifier();
 
     /**
      * @brief Read a string from the source code.
      *
      * @param quote The quote character used to delimit the string.
+     * @param triple Whether the string is delimited by three quotes.
      * @return The string.
      */
-    std::string _readString(const std::string& quote);
-    bool _isHexDigit(const std::string& character);
+    std::string _readString(char quote, bool triple);
+
+    /**
+     * @brief Read a comment token from the source code, for tokenize_coment.
+     *
+     * @return The comment token.
+     */
+    token::Token _readComent();
 };
-#endif
\ No newline at end of file
+#endif
@@ -10,6 +10,7 @@
 #ifndef TOKENS_HPP
 #define TOKENS_HPP
 #include <string>
+#include <utility>
 
 namespace token {
 
@@ -167,7 +168,7 @@ class Token {
      * @param colNo The column number where the token starts.
      */
     inline Token(TokenType type, std::string literal, int stLineNo, int lineNo, int colNo, int endColNo)
-        : type(type), literal(literal), st_line_no(stLineNo), end_line_no(lineNo), end_col_no(endColNo), col_no(colNo) {};
+        : type(type), literal(std::move(literal)), st_line_no(stLineNo), end_line_no(lineNo), end_col_no(endColNo), col_no(colNo) {};
 
     /**
      * @brief Convert the current token to a string.
@@ -0,0 +1,138 @@
+/**
+ * @file lexer_bench.cpp
+ * @brief Lexer throughput benchmark: tokenizes sources repeatedly and reports MB/s.
+ *
+ * Without input files a GigglyCode source of `--lines` lines is generated, mixing
+ * structs, functions, arithmetic, strings with escapes, floats and comments the way
+ * real code does. Every iteration constructs a Lexer (copying the source, as the
+ * compiler does) and reads tokens until the end of the file.
+ *
+ * With `--tokens` the tokens are printed instead, one per line the way the
+ * compiler's lexer debug log shows them, so the token stream can be compared
+ * with a stored one (`make test` does, for the sources in test/lexer).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "compilation_state.hpp"
+#include "include/cli11.hpp"
+#include "lexer/lexer.hpp"
+
+namespace {
+
+// A source of about `lines` lines; the same text for the same count
+std::string generateSource(size_t lines) {
+    std::string source;
+    source.reserve(lines * 40);
+    size_t line = 0;
+    for (size_t unit = 0; line < lines; ++unit) {
+        std::string id = std::to_string(unit);
+        source += "# Unit " + id + ": a struct, its constructor and some arithmetic\n";
+        source += "struct Point" + id + " {\n    x: float64;\n    y: float64;\n    label: str;\n}\n\n";
+        source += "def make_point" + id + "(x: float64, y: float64) -> Point" + id + " {\n";
+        source += "    point := Point" + id + "(x, y, \"point\\t" + id + "\\n\");\n";
+        source += "    return point;\n}\n\n";
+        source += "def step" + id + "(values: array[int64], count: int64) -> int64 {\n";
+        source += "    total: int64 = 0;\n";
+        source += "    for (i := 0; count > i; i = i + 1) {\n";
+        source += "        if (values[i] % 3 == 0 and values[i] != -17) {\n";
+        source += "            total += values[i] * 31 + (values[i] >> 2); # running sum\n";
+        source += "        } elif (values[i] <= 1024) {\n";
+        source += "            total -= 0.5 * values[i];\n";
+        source += "        } else {\n";
+        source += "            printf('%d: %s\\x21\\n', i, \"\"\"multi\nline\"\"\");\n";
+        source += "        }\n    }\n    return total;\n}\n\n";
+        line += 26;
+    }
+    return source;
+}
+
+/**
+ * @struct Run
+ * @brief One pass of the lexer over every source.
+ */
+struct Run {
+    double seconds = 0;
+    size_t tokens = 0;
+};
+
+Run lexAll(const std::vector<std::string>& sources, const std::vector<std::filesystem::path>& paths, bool tokenizeComents) {
+    Run run;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t idx = 0; idx < sources.size(); ++idx) {
+        Lexer lexer(sources[idx], paths[idx], tokenizeComents);
+        while (lexer.nextToken().type != token::TokenType::EndOfFile) run.tokens++;
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+// Every token of every source, through the end of the file
+void printTokens(const std::vector<std::string>& sources, const std::vector<std::filesystem::path>& paths, bool tokenizeComents) {
+    for (size_t idx = 0; idx < sources.size(); ++idx) {
+        Lexer lexer(sources[idx], paths[idx], tokenizeComents);
+        while (true) {
+            auto token = lexer.nextToken();
+            std::cout << token.toString(false) << "\n";
+            if (token.type == token::TokenType::EndOfFile) break;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CLI::App app{"GigglyCode Lexer Benchmark"};
+
+    std::vector<std::filesystem::path> files;
+    size_t lines = 100000;
+    int iterations = 10;
+    bool tokenizeComents = false;
+    bool tokens = false;
+
+    app.add_option("files", files, "Sources to tokenize; default: a generated source of --lines lines")->check(CLI::ExistingFile);
+    app.add_option("--lines", lines, "Lines of the generated source")->default_val(100000);
+    app.add_option("-n,--iterations", iterations, "Passes over the sources; the median and the best are reported")->default_val(10)->check(CLI::PositiveNumber);
+    app.add_flag("--comments", tokenizeComents, "Return comments as tokens, as error highlighting does");
+    app.add_flag("--tokens", tokens, "Print the tokens of the sources instead of timing the lexer");
+    CLI11_PARSE(app, argc, argv);
+
+    std::vector<std::string> sources;
+    std::vector<std::filesystem::path> paths;
+    if (files.empty()) {
+        sources.push_back(generateSource(lines));
+        paths.push_back("generated.gc");
+    } else {
+        for (const auto& file : files) {
+            sources.push_back(Utils::readFileToString(file));
+            paths.push_back(file);
+        }
+    }
+    if (tokens) {
+        printTokens(sources, paths, tokenizeComents);
+        std::cout << std::flush;
+        return 0;
+    }
+    size_t bytes = 0;
+    for (const auto& source : sources) bytes += source.size();
+
+    // The first pass warms the caches & the allocator and is not counted
+    lexAll(sources, paths, tokenizeComents);
+    std::vector<Run> runs;
+    for (int run = 0; run < iterations; ++run) runs.push_back(lexAll(sources, paths, tokenizeComents));
+    std::sort(runs.begin(), runs.end(), [](const Run& lhs, const Run& rhs) { return lhs.seconds < rhs.seconds; });
+
+    const Run& best = runs.front();
+    const Run& median = runs[runs.size() / 2];
+    double megabytes = bytes / 1e6;
+    std::cout << sources.size() << " source(s), " << megabytes << " MB, " << best.tokens << " tokens per pass\n";
+    std::cout << "median: " << megabytes / median.seconds << " MB/s, " << median.seconds * 1e9 / std::max<size_t>(median.tokens, 1) << " ns/token\n";
+    std::cout << "best:   " << megabytes / best.seconds << " MB/s, " << best.seconds * 1e9 / std::max<size_t>(best.tokens, 1) << " ns/token" << std::endl;
+    return 0;
+}
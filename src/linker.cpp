@@ -0,0 +1,174 @@
+#include "linker.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/TargetParser/Host.h>
+
+#include "compilation_state.hpp"
+
+#ifdef GIGLY_HAS_LLD
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/DiagnosticIDs.h>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/Driver/Compilation.h>
+#include <clang/Driver/Driver.h>
+#include <clang/Driver/Job.h>
+#include <lld/Common/Driver.h>
+#include <memory>
+
+LLD_HAS_DRIVER(elf)
+#endif
+
+namespace linker {
+
+// Quotes an argument for a GNU-style response file
+static std::string quoteArgument(const std::string& arg) {
+    std::string quoted = "\"";
+    for (char c : arg) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static std::string findClangDriver() {
+    if (auto clang = llvm::sys::findProgramByName("clang++")) return *clang;
+    return "clang++";
+}
+
+// Driver arguments shared by the embedded and the external link
+static std::vector<std::string> driverArguments(const LinkOptions& options) {
+    std::vector<std::string> args;
+    if (!options.target_triple.empty()) args.push_back("--target=" + options.target_triple);
+    if (options.gcSections) args.push_back("-Wl,--gc-sections");
+    return args;
+}
+
+#ifdef GIGLY_HAS_LLD
+namespace {
+
+// Collects clang driver diagnostics into a string
+class CollectingDiagConsumer : public clang::DiagnosticConsumer {
+  public:
+    explicit CollectingDiagConsumer(std::string& out) : out(out) {}
+
+    void HandleDiagnostic(clang::DiagnosticsEngine::Level level, const clang::Diagnostic& info) override {
+        clang::DiagnosticConsumer::HandleDiagnostic(level, info);
+        llvm::SmallString<128> message;
+        info.FormatDiagnostic(message);
+        out += message.str().str() + "\n";
+    }
+
+  private:
+    std::string& out;
+};
+
+} // namespace
+
+/**
+ * @brief Links through lld inside this process.
+ *
+ * The clang driver builds the link job exactly as `clang++ -fuse-ld=lld`
+ * would, but instead of executing it the arguments are handed to lld's ELF
+ * entry point.
+ *
+ * @return false with `handled == false` when the driver reports an error or
+ *         the target's linker is not ld.lld, so the caller can fall back to
+ *         the external driver.
+ */
+static bool linkEmbedded(const LinkOptions& options, std::string& diagnostics, bool& handled) {
+    handled = false;
+
+    std::string clang_path = findClangDriver();
+    std::vector<std::string> args_storage = {clang_path, "-fuse-ld=lld"};
+    for (const auto& arg : driverArguments(options)) args_storage.push_back(arg);
+    if (options.threads != 0) args_storage.push_back("-Wl,--threads=" + std::to_string(options.threads));
+    for (const auto& object : options.objects) args_storage.push_back(object.string());
+    args_storage.push_back("-o");
+    args_storage.push_back(options.output.string());
+
+    std::vector<const char*> driver_args;
+    for (const auto& arg : args_storage) driver_args.push_back(arg.c_str());
+
+    CollectingDiagConsumer diag_consumer(diagnostics);
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> diag_ids(new clang::DiagnosticIDs());
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diag_options(new clang::DiagnosticOptions());
+    clang::DiagnosticsEngine diags(diag_ids, diag_options, &diag_consumer, false);
+
+    std::string triple = options.target_triple.empty() ? llvm::sys::getDefaultTargetTriple() : options.target_triple;
+    clang::driver::Driver driver(clang_path, triple, diags, "gigly linker");
+    std::unique_ptr<clang::driver::Compilation> compilation(driver.BuildCompilation(driver_args));
+    // A driver that cannot set up the link (toolchain or sysroot lookup) leaves it to clang++
+    if (!compilation || compilation->containsError()) {
+        if (options.verbose) std::cout << "In-process link unavailable, falling back to clang++:\n" << diagnostics << std::flush;
+        return false;
+    }
+
+    // Only objects are passed in, so the link is the one and only job
+    const auto& jobs = compilation->getJobs();
+    if (jobs.size() != 1) return false;
+    const clang::driver::Command& link_job = *jobs.begin();
+    auto linker_name = std::filesystem::path(link_job.getExecutable()).filename().string();
+    if (linker_name != "ld.lld" && linker_name != "lld") return false;
+
+    std::vector<const char*> lld_args = {"ld.lld"};
+    for (const char* arg : link_job.getArguments()) lld_args.push_back(arg);
+
+    if (options.verbose) {
+        std::cout << "Link Command (in-process):";
+        for (const char* arg : lld_args) std::cout << " " << arg;
+        std::cout << std::endl;
+    }
+
+    handled = true;
+    llvm::raw_string_ostream lld_out(diagnostics);
+    lld::Result result = lld::lldMain(lld_args, lld_out, lld_out, {{lld::Gnu, &lld::elf::link}});
+    lld_out.flush();
+    return result.retCode == 0;
+}
+#endif
+
+// Links by running the clang++ driver with the objects in a response file
+static bool linkExternal(const LinkOptions& options, std::string& diagnostics) {
+    std::filesystem::path response_file = options.buildDir / "link.rsp";
+    {
+        std::ofstream rsp(response_file, std::ios::trunc);
+        if (!rsp) {
+            diagnostics = "Could not write linker response file " + response_file.string();
+            return false;
+        }
+        for (const auto& object : options.objects) rsp << quoteArgument(object.string()) << "\n";
+    }
+
+    std::string command = "clang++";
+    for (const auto& arg : driverArguments(options)) command += " \"" + arg + "\"";
+    command += " @\"" + response_file.string() + "\" -o \"" + options.output.string() + "\" 2>&1";
+    if (options.verbose) { std::cout << "Link Command: " << command << std::endl; }
+
+    int exit_code;
+    diagnostics = runCommand(command, exit_code);
+    return exit_code == 0;
+}
+
+bool hasEmbeddedLinker() {
+#ifdef GIGLY_HAS_LLD
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool link(const LinkOptions& options, std::string& diagnostics) {
+#ifdef GIGLY_HAS_LLD
+    bool handled = false;
+    bool linked = linkEmbedded(options, diagnostics, handled);
+    if (handled) return linked;
+    diagnostics.clear();
+#endif
+    return linkExternal(options, diagnostics);
+}
+
+} // namespace linker
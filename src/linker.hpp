@@ -0,0 +1,51 @@
+#ifndef LINKER_HPP
+#define LINKER_HPP
+
+/**
+ * @file linker.hpp
+ * @brief Links the objects of a build into an executable.
+ *
+ * When gigly is built against the lld libraries (GIGLY_HAS_LLD), the clang
+ * driver library works out the platform link line (crt files, libc, library
+ * search paths) and lld runs inside the gigly process. Otherwise, or for
+ * targets whose linker is not ld.lld, `clang++` is invoked with a response
+ * file so the object list is never limited by the shell's command length.
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace linker {
+
+/**
+ * @struct LinkOptions
+ * @brief Inputs of a single link.
+ */
+struct LinkOptions {
+    std::vector<std::filesystem::path> objects; ///< Exactly the objects to link
+    std::filesystem::path output;               ///< Executable to write
+    std::filesystem::path buildDir;             ///< Scratch directory for the response file
+    std::string target_triple;                  ///< Empty = host native
+    bool gcSections = false;                    ///< Pass --gc-sections to the linker
+    unsigned threads = 0;                       ///< lld worker threads; 0 = lld default
+    bool verbose = false;
+};
+
+/**
+ * @brief Links `options.objects` into `options.output`.
+ *
+ * @param options What to link and how.
+ * @param diagnostics Receives the linker / driver output.
+ * @return true on success.
+ */
+bool link(const LinkOptions& options, std::string& diagnostics);
+
+/**
+ * @brief Whether this build of gigly can link in-process.
+ */
+bool hasEmbeddedLinker();
+
+} // namespace linker
+
+#endif // LINKER_HPP
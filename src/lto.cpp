@@ -0,0 +1,144 @@
+#include "lto.hpp"
+
+#include <llvm/LTO/Config.h>
+#include <llvm/LTO/LTO.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/Caching.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/TargetParser/Host.h>
+#include <memory>
+#include <unordered_set>
+
+#include "compiler/codegen.hpp"
+
+namespace linker {
+
+// Link time `-O` level; without one the LTO default (2) is used
+static unsigned ltoOptLevel(const std::string& optimization_level) {
+    if (optimization_level == "0") return 0;
+    if (optimization_level == "1") return 1;
+    if (optimization_level == "3" || optimization_level == "fast") return 3;
+    return 2;
+}
+
+// Symbols the native objects leave undefined; they must survive internalization
+static bool collectNativeReferences(const std::vector<std::filesystem::path>& objects, std::unordered_set<std::string>& referenced, llvm::raw_ostream& diagnostics) {
+    for (const auto& path : objects) {
+        auto buffer = llvm::MemoryBuffer::getFile(path.string());
+        if (!buffer) {
+            diagnostics << path.string() << ": " << buffer.getError().message() << "\n";
+            return false;
+        }
+        auto object = llvm::object::ObjectFile::createObjectFile((*buffer)->getMemBufferRef());
+        if (!object) {
+            diagnostics << path.string() << ": " << llvm::toString(object.takeError()) << "\n";
+            return false;
+        }
+        for (const auto& symbol : (*object)->symbols()) {
+            auto flags = symbol.getFlags();
+            if (!flags) {
+                llvm::consumeError(flags.takeError());
+                continue;
+            }
+            if (!(*flags & llvm::object::SymbolRef::SF_Undefined)) continue;
+            auto name = symbol.getName();
+            if (!name) {
+                llvm::consumeError(name.takeError());
+                continue;
+            }
+            referenced.insert(name->str());
+        }
+    }
+    return true;
+}
+
+bool linkTimeOptimize(const LTOOptions& options, std::vector<std::filesystem::path>& objects, std::string& diagnostics) {
+    llvm::raw_string_ostream diagnostics_stream(diagnostics);
+
+    // Nothing may have been compiled in this process when every module was up to date
+    compiler::TargetRegistry::initializeTargets();
+
+    std::unordered_set<std::string> exported = {"main"};
+    if (!collectNativeReferences(options.nativeObjects, exported, diagnostics_stream)) return false;
+
+    llvm::lto::Config config;
+    config.DefaultTriple = options.target_triple.empty() ? llvm::sys::getDefaultTargetTriple() : options.target_triple;
+    config.CPU = "generic";
+    config.Options.FunctionSections = true;
+    config.Options.DataSections = true;
+    config.RelocModel = llvm::Reloc::PIC_;
+    config.OptLevel = ltoOptLevel(options.optimizationLevel);
+    config.CGOptLevel = compiler::codeGenOptLevel(options.optimizationLevel.empty() ? "2" : options.optimizationLevel);
+    config.OptPipeline = options.passPipeline;
+
+    auto parallelism = llvm::heavyweight_hardware_concurrency(options.threads);
+    llvm::lto::ThinBackend backend;
+    if (options.mode == compiler::LTOMode::Thin) backend = llvm::lto::createInProcessThinBackend(parallelism);
+    // Full LTO splits the merged module for parallel code generation
+    unsigned codegen_threads = options.mode == compiler::LTOMode::Full ? parallelism.compute_thread_count() : 1;
+    llvm::lto::LTO lto(std::move(config), std::move(backend), codegen_threads);
+
+    // The buffers back the input files until the LTO run is over
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+    std::unordered_set<std::string> defined;
+    for (const auto& path : options.bitcode) {
+        auto buffer = llvm::MemoryBuffer::getFile(path.string());
+        if (!buffer) {
+            diagnostics_stream << path.string() << ": " << buffer.getError().message() << "\n";
+            return false;
+        }
+        auto input = llvm::lto::InputFile::create((*buffer)->getMemBufferRef());
+        if (!input) {
+            diagnostics_stream << path.string() << ": " << llvm::toString(input.takeError()) << "\n";
+            return false;
+        }
+
+        std::vector<llvm::lto::SymbolResolution> resolutions;
+        for (const auto& symbol : (*input)->symbols()) {
+            llvm::lto::SymbolResolution resolution;
+            std::string name = symbol.getName().str();
+            if (!symbol.isUndefined()) {
+                // Like a linker, the first definition wins
+                resolution.Prevailing = defined.insert(name).second;
+                resolution.FinalDefinitionInLinkageUnit = true;
+            }
+            // Everything else gets internalized, so it can be inlined and dropped
+            resolution.VisibleToRegularObj = exported.count(name) != 0;
+            resolutions.push_back(resolution);
+        }
+        if (auto err = lto.add(std::move(*input), resolutions)) {
+            diagnostics_stream << path.string() << ": " << llvm::toString(std::move(err)) << "\n";
+            return false;
+        }
+        buffers.push_back(std::move(*buffer));
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    // Tasks run on the backend threads, each writing its own slot
+    std::vector<std::filesystem::path> produced(lto.getMaxTasks());
+    auto add_stream = [&](unsigned task, const llvm::Twine&) -> llvm::Expected<std::unique_ptr<llvm::CachedFileStream>> {
+        std::filesystem::path path = options.outputDir / ("lto." + std::to_string(task) + ".o");
+        std::error_code stream_ec;
+        auto stream = std::make_unique<llvm::raw_fd_ostream>(path.string(), stream_ec, llvm::sys::fs::OF_None);
+        if (stream_ec) return llvm::errorCodeToError(stream_ec);
+        produced[task] = path;
+        return std::make_unique<llvm::CachedFileStream>(std::move(stream), path.string());
+    };
+    if (auto err = lto.run(add_stream)) {
+        diagnostics_stream << llvm::toString(std::move(err)) << "\n";
+        return false;
+    }
+
+    objects.clear();
+    for (auto& path : produced) {
+        if (!path.empty()) objects.push_back(std::move(path));
+    }
+    return true;
+}
+
+} // namespace linker
@@ -0,0 +1,50 @@
+#ifndef LTO_HPP
+#define LTO_HPP
+
+/**
+ * @file lto.hpp
+ * @brief Whole-program optimization of the bitcode written by `gigly --lto`.
+ *
+ * Runs LLVM's LTO library in-process. Every symbol is internalized except
+ * `main` and the symbols the native objects (C and Rust files) reference, so
+ * the optimizer may inline and drop across module boundaries. Full LTO merges
+ * all modules into one; ThinLTO keeps them apart and imports functions
+ * between them using the module summaries, on `threads` workers.
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "compiler/optimizer.hpp"
+
+namespace linker {
+
+/**
+ * @struct LTOOptions
+ * @brief Inputs of a link time optimization.
+ */
+struct LTOOptions {
+    std::vector<std::filesystem::path> bitcode;        ///< Bitcode of every .gc module
+    std::vector<std::filesystem::path> nativeObjects;  ///< Objects linked alongside, scanned for the symbols they need
+    std::filesystem::path outputDir;                   ///< Where the optimized objects are written
+    std::string target_triple;                         ///< Empty = host native
+    std::string optimizationLevel;                     ///< `-O` level of the link time pipeline
+    std::string passPipeline;                          ///< Custom pipeline replacing the `-O` one
+    compiler::LTOMode mode = compiler::LTOMode::Full;
+    unsigned threads = 0;                              ///< Backend threads; 0 = one per core
+};
+
+/**
+ * @brief Optimizes `options.bitcode` as one program and lowers it to objects.
+ *
+ * @param options What to optimize and how.
+ * @param objects Receives the objects to link instead of the bitcode.
+ * @param diagnostics Receives the error message on failure.
+ * @return true on success.
+ */
+bool linkTimeOptimize(const LTOOptions& options, std::vector<std::filesystem::path>& objects, std::string& diagnostics);
+
+} // namespace linker
+
+#endif // LTO_HPP
@@ -0,0 +1,134 @@
+#include "object_cache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/SHA256.h>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace compilationState {
+
+// Bump whenever the layout of an entry or the key changes
+static constexpr int CACHE_VERSION = 1;
+
+// Names of the artifacts inside an entry
+static const char* OBJECT_BLOB = "object";
+static const char* INTERFACE_BLOB = "interface.gci";
+static const char* BITCODE_BLOB = "module.bc";
+static const char* IR_BLOB = "module.ll";
+
+static std::vector<std::pair<const char*, const std::filesystem::path*>> blobsOf(const CacheArtifacts& artifacts) {
+    std::vector<std::pair<const char*, const std::filesystem::path*>> blobs;
+    if (!artifacts.object.empty()) blobs.emplace_back(OBJECT_BLOB, &artifacts.object);
+    if (!artifacts.interface.empty()) blobs.emplace_back(INTERFACE_BLOB, &artifacts.interface);
+    if (!artifacts.bitcode.empty()) blobs.emplace_back(BITCODE_BLOB, &artifacts.bitcode);
+    if (!artifacts.ir.empty()) blobs.emplace_back(IR_BLOB, &artifacts.ir);
+    return blobs;
+}
+
+// Copies through a temporary next to the target, so readers never see half a file
+static bool copyAtomically(const std::filesystem::path& from, const std::filesystem::path& to) {
+    std::ostringstream suffix;
+    suffix << ".tmp." << getpid() << "." << std::this_thread::get_id();
+    std::filesystem::path temporary = to;
+    temporary += suffix.str();
+    std::error_code ec;
+    std::filesystem::create_directories(to.parent_path(), ec);
+    if (!std::filesystem::copy_file(from, temporary, std::filesystem::copy_options::overwrite_existing, ec)) return false;
+    std::filesystem::rename(temporary, to, ec);
+    if (ec) std::filesystem::remove(temporary, ec);
+    return !ec;
+}
+
+std::filesystem::path ObjectCache::defaultDirectory() {
+    // XDG requires an absolute path; anything else is ignored
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && std::filesystem::path(xdg).is_absolute()) return std::filesystem::path(xdg) / "gigly";
+    if (const char* home = std::getenv("HOME"); home && *home) return std::filesystem::path(home) / ".cache" / "gigly";
+    return std::filesystem::temp_directory_path() / "gigly-cache";
+}
+
+std::string ObjectCache::key(const std::string& relative, const ManifestEntry& entry) {
+    std::ostringstream inputs;
+    inputs << "v" << CACHE_VERSION << "\n"
+           << relative << "\n"
+           << entry.source_hash << "\n"
+           << entry.imports_hash << "\n"
+           << entry.compiler_id << "\n"
+           << entry.target_triple << "\n"
+           << entry.optimization_level << "\n"
+           << entry.pass_pipeline << "\n"
+           << entry.lto << "\n";
+    auto digest = llvm::SHA256::hash(llvm::arrayRefFromStringRef(inputs.str()));
+    return llvm::toHex(digest, true);
+}
+
+bool ObjectCache::fetch(const std::string& key, const CacheArtifacts& artifacts) {
+    std::filesystem::path entry = entryPath(key);
+    auto blobs = blobsOf(artifacts);
+    std::error_code ec;
+    for (const auto& [name, target] : blobs) {
+        if (!std::filesystem::exists(entry / name, ec)) {
+            miss_count++;
+            return false;
+        }
+    }
+    for (const auto& [name, target] : blobs) {
+        if (!copyAtomically(entry / name, *target)) {
+            miss_count++;
+            return false;
+        }
+    }
+    // The entry's modification time is its last use
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+    hit_count++;
+    return true;
+}
+
+void ObjectCache::store(const std::string& key, const CacheArtifacts& artifacts) {
+    std::filesystem::path entry = entryPath(key);
+    std::error_code ec;
+    for (const auto& [name, source] : blobsOf(artifacts)) {
+        if (std::filesystem::exists(entry / name, ec) || !std::filesystem::exists(*source, ec)) continue;
+        copyAtomically(*source, entry / name);
+    }
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+}
+
+void ObjectCache::evict() {
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type used;
+        uintmax_t size = 0;
+    };
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+
+    std::error_code ec;
+    for (std::filesystem::directory_iterator shard(directory, ec), end; !ec && shard != end; shard.increment(ec)) {
+        if (!shard->is_directory(ec)) continue;
+        std::error_code entry_ec;
+        for (std::filesystem::directory_iterator it(shard->path(), entry_ec); !entry_ec && it != end; it.increment(entry_ec)) {
+            Entry entry{it->path(), it->last_write_time(entry_ec)};
+            std::error_code blob_ec;
+            for (std::filesystem::directory_iterator blob(it->path(), blob_ec); !blob_ec && blob != end; blob.increment(blob_ec)) {
+                entry.size += blob->file_size(blob_ec);
+            }
+            total += entry.size;
+            entries.push_back(std::move(entry));
+        }
+    }
+    if (total <= max_size) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    for (const auto& entry : entries) {
+        if (total <= max_size) break;
+        std::filesystem::remove_all(entry.path, ec);
+        total -= entry.size;
+    }
+}
+
+} // namespace compilationState
@@ -0,0 +1,94 @@
+#ifndef OBJECT_CACHE_HPP
+#define OBJECT_CACHE_HPP
+
+/**
+ * @file object_cache.hpp
+ * @brief Content-addressed cache of compiled .gc files, shared by every build directory.
+ *
+ * An entry is keyed by everything a ManifestEntry compares (source hash,
+ * interface hashes of the imports, compiler id, target triple and the
+ * optimization settings) plus the path of the file inside src/, which the
+ * symbol names are derived from. It holds the object (bitcode under --lto),
+ * the module interface and, when they were asked for, the bitcode and IR.
+ *
+ * Entries are written file by file through a rename, so concurrent builds
+ * never see a partial blob. Reading an entry marks it used; evict() drops the
+ * least recently used entries once the cache outgrows its size limit.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "build_manifest.hpp"
+
+namespace compilationState {
+
+/**
+ * @struct CacheArtifacts
+ * @brief Where the outputs of one file live in the build directory; empty paths are not wanted.
+ */
+struct CacheArtifacts {
+    std::filesystem::path object;
+    std::filesystem::path interface;
+    std::filesystem::path bitcode;
+    std::filesystem::path ir;
+};
+
+/**
+ * @class ObjectCache
+ * @brief A local directory of compiled artifacts, addressed by their inputs.
+ */
+class ObjectCache {
+  public:
+    /**
+     * @param directory Root of the cache; created on first store.
+     * @param max_size Size in bytes evict() trims the cache to.
+     */
+    ObjectCache(const std::filesystem::path& directory, uintmax_t max_size) : directory(directory), max_size(max_size) {}
+
+    /**
+     * @brief `$XDG_CACHE_HOME/gigly`, falling back to `~/.cache/gigly`.
+     */
+    static std::filesystem::path defaultDirectory();
+
+    /**
+     * @brief The key of a file's outputs.
+     * @param relative Path of the file relative to the source directory.
+     * @param entry Its current inputs.
+     */
+    static std::string key(const std::string& relative, const ManifestEntry& entry);
+
+    /**
+     * @brief Copies the cached outputs of `key` into the build directory.
+     * @return false, copying nothing, unless every wanted artifact is cached.
+     */
+    bool fetch(const std::string& key, const CacheArtifacts& artifacts);
+
+    /**
+     * @brief Adds the artifacts of `key` the cache does not hold yet.
+     */
+    void store(const std::string& key, const CacheArtifacts& artifacts);
+
+    /**
+     * @brief Drops least recently used entries until the cache fits its size limit.
+     */
+    void evict();
+
+    const std::filesystem::path& root() const { return directory; }
+    size_t hits() const { return hit_count; }
+    size_t misses() const { return miss_count; }
+
+  private:
+    std::filesystem::path entryPath(const std::string& key) const { return directory / key.substr(0, 2) / key; }
+
+    std::filesystem::path directory;
+    uintmax_t max_size;
+    std::atomic<size_t> hit_count = 0;
+    std::atomic<size_t> miss_count = 0;
+};
+
+} // namespace compilationState
+
+#endif // OBJECT_CACHE_HPP
@@ -0,0 +1,270 @@
+#include "repl.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "compilation_state.hpp"
+#include "compiler/codegen.hpp"
+#include "compiler/compiler.hpp"
+#include "errors/errors.hpp"
+#include "jit.hpp"
+#include "lexer/lexer.hpp"
+#include "parser/parser.hpp"
+
+namespace repl {
+
+namespace {
+
+const char* HELP = "Enter definitions (def, struct, enum, import, global variables) or statements.\n"
+                   "Input continues on the next line while brackets are open.\n"
+                   "  :time <expr>  Evaluate <expr> many times and report the time per evaluation\n"
+                   "  :help         Show this help\n"
+                   "  :quit         Leave the REPL (or end of file)\n";
+
+// A batch of :time evaluations has to take at least this long to be trusted
+constexpr std::chrono::milliseconds MIN_BATCH_TIME(50);
+constexpr int TIME_BATCHES = 5;
+
+bool isDefinition(AST::Statement* statement) {
+    switch (statement->type()) {
+        case AST::NodeType::FunctionStatement:
+        case AST::NodeType::StructStatement:
+        case AST::NodeType::EnumStatement:
+        case AST::NodeType::ImportStatement:
+        case AST::NodeType::VariableDeclarationStatement:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Brackets still open in `text`; those in strings & comments do not count
+int openBrackets(const std::string& text) {
+    int open = 0;
+    char quote = 0;
+    bool comment = false;
+    for (size_t idx = 0; idx < text.size(); ++idx) {
+        char c = text[idx];
+        if (comment) {
+            if (c == '\n') comment = false;
+        } else if (quote) {
+            if (c == '\\') ++idx;
+            else if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '#') {
+            comment = true;
+        } else if (c == '(' || c == '[' || c == '{') {
+            open++;
+        } else if (c == ')' || c == ']' || c == '}') {
+            open--;
+        }
+    }
+    return open;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+// Reads lines until the brackets of the input are balanced; false at end of file
+bool readInput(std::string& input) {
+    input.clear();
+    std::string line;
+    std::cout << ">>> " << std::flush;
+    while (std::getline(std::cin, line)) {
+        input += line + "\n";
+        if (openBrackets(input) <= 0) return true;
+        std::cout << "... " << std::flush;
+    }
+    return !trim(input).empty();
+}
+
+uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Calls `function` in batches, doubling the batch until it takes MIN_BATCH_TIME, and reports the fastest of TIME_BATCHES.
+ *
+ * The cost of the indirect call is included.
+ */
+void benchmark(void (*function)()) {
+    using clock = std::chrono::steady_clock;
+    auto batch = [function](uint64_t iterations, uint64_t& cycles) {
+        uint64_t firstCycle = readCycles();
+        auto start = clock::now();
+        for (uint64_t idx = 0; idx < iterations; ++idx) function();
+        auto elapsed = clock::now() - start;
+        cycles = readCycles() - firstCycle;
+        return elapsed;
+    };
+
+    uint64_t iterations = 1;
+    uint64_t cycles = 0;
+    // Output of the expression would be repeated for every call
+    std::fflush(stdout);
+    while (batch(iterations, cycles) < MIN_BATCH_TIME && iterations < (uint64_t(1) << 40)) iterations *= 2;
+
+    double bestNs = 0;
+    double bestCycles = 0;
+    for (int run = 0; run < TIME_BATCHES; ++run) {
+        double ns = std::chrono::duration<double, std::nano>(batch(iterations, cycles)).count() / iterations;
+        if (run == 0 || ns < bestNs) {
+            bestNs = ns;
+            bestCycles = static_cast<double>(cycles) / iterations;
+        }
+    }
+    std::fflush(stdout);
+    std::cout << iterations << " iterations x " << TIME_BATCHES << ", best: " << bestNs << " ns";
+    if (bestCycles > 0) std::cout << ", " << bestCycles << " cycles (TSC)";
+    std::cout << " per evaluation" << std::endl;
+}
+
+/**
+ * @class Session
+ * @brief The compiler, its environment and the JIT inputs are added to.
+ */
+class Session {
+  public:
+    Session(const Options& options, jit::Session& jit)
+        : options(options), jit(jit),
+          // Named like a project's main.gc, so definitions keep their plain names
+          compiler("", std::filesystem::current_path() / "src" / "main.gc", findOrCreateFileRecord(&folder, "main.gc"), std::filesystem::current_path() / "build", "main.gc") {}
+
+    /**
+     * @brief Compiles an input; errors end the process.
+     * @param input The text entered.
+     * @param timed Whether it is the expression of `:time`.
+     * @return The function to call for statements, "" for definitions.
+     */
+    std::string compile(const std::string& input, bool timed) {
+        std::string source = input;
+        auto program = parse(source);
+        size_t definitions = std::count_if(program->statements.begin(), program->statements.end(), isDefinition);
+        if (timed && definitions > 0) errors::raiseCompilationError(":time takes an expression, not a definition");
+        if (definitions > 0 && definitions < program->statements.size()) {
+            errors::raiseCompilationError("Definitions and statements cannot be entered together", "Enter the definitions first, then the statements.");
+        }
+
+        std::string entry;
+        if (definitions == 0) {
+            entry = (timed ? "__repl_time_" : "__repl_") + std::to_string(inputs);
+            source = "def " + entry + "() -> void {\n" + input + "\n}\n";
+            program = parse(source);
+        }
+        compiler.setSource(source);
+        // The function returns nothing, so the timed value is sunk instead; otherwise -O could delete it
+        compiler.sink_expression_values = timed;
+        compiler.compile(program);
+        return entry;
+    }
+
+    /**
+     * @brief Adds what the last compile() produced to the JIT.
+     * @return The address of `entry`, null for definitions or if the JIT failed.
+     */
+    void* commit(const std::string& entry) {
+        inputs++;
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = compiler.takeIncrementalModule(*context);
+        if (!options.optimizationLevel.empty()) {
+            auto target_machine = compiler::acquireTargetMachine(module->getTargetTriple());
+            compiler::optimizeModule(*module, target_machine.get(), options.optimizationLevel);
+        }
+        if (options.verbose) module->print(llvm::outs(), nullptr);
+
+        std::string diagnostics;
+        if (!jit.add({std::move(context), std::move(module)}, diagnostics)) {
+            std::cerr << "Error: " << diagnostics << std::endl;
+            return nullptr;
+        }
+        if (entry.empty()) return nullptr;
+        void* address = jit.lookup(entry, diagnostics);
+        if (!address) std::cerr << "Error: " << diagnostics << std::endl;
+        return address;
+    }
+
+  private:
+    AST::Program* parse(const std::string& source) {
+        Lexer lexer(source, "<repl>");
+        parser::Parser parser(&lexer);
+        programs.emplace_back(parser.parseProgram());
+        return programs.back();
+    }
+
+    const Options& options;
+    jit::Session& jit;
+    compilationState::RecordFolder folder; // Owns the environment, so it outlives compiler; imports are recorded here too
+    compiler::Compiler compiler;
+    std::vector<AST::Program*> programs; // Records point into them, so every input is kept
+    size_t inputs = 0;
+};
+
+} // namespace
+
+int run(const Options& options) {
+    std::string diagnostics;
+    auto jit = jit::Session::create(diagnostics);
+    if (!jit) {
+        std::cerr << "Error: could not start the JIT: " << diagnostics << std::endl;
+        return 1;
+    }
+    Session session(options, *jit);
+    std::cout << "GigglyCode REPL, :help for commands" << std::endl;
+
+    std::string input;
+    while (readInput(input)) {
+        std::string text = trim(input);
+        if (text.empty()) continue;
+        if (text == ":quit" || text == ":q") break;
+        if (text == ":help") {
+            std::cout << HELP;
+            continue;
+        }
+        bool timed = text == ":time" || (text.rfind(":time", 0) == 0 && std::isspace(static_cast<unsigned char>(text[5])));
+        if (!timed && text[0] == ':') {
+            std::cerr << "Unknown command " << text << ", :help lists them" << std::endl;
+            continue;
+        }
+        std::string code = timed ? trim(text.substr(5)) : text;
+        if (code.empty()) {
+            std::cerr << ":time needs an expression, as in :time fib(20)" << std::endl;
+            continue;
+        }
+        if (code.back() != ';' && code.back() != '}') code += ";";
+
+        // Errors end the process raising them, so a copy of the session tries the input first;
+        // only input that compiles there is compiled here
+        if (Utils::runInChild([&]() { return session.compile(code, timed), 0; }) != 0) continue;
+        void* entry = session.commit(session.compile(code, timed));
+        if (!entry) continue;
+        auto function = reinterpret_cast<void (*)()>(entry);
+        if (timed) benchmark(function);
+        else function();
+        std::fflush(stdout);
+    }
+    return 0;
+}
+
+} // namespace repl
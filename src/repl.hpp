@@ -0,0 +1,35 @@
+#ifndef REPL_HPP
+#define REPL_HPP
+
+/**
+ * @file repl.hpp
+ * @brief `gigly repl`: an interactive GigglyCode prompt on top of the JIT.
+ *
+ * Every input is compiled by one long-lived Compiler, so its environment,
+ * and with it every earlier definition, stays visible. The functions, structs,
+ * enums and globals an input defines are added to the JIT as a module of their
+ * own; statements are wrapped in a function that is compiled and called.
+ */
+
+#include <string>
+
+namespace repl {
+
+/**
+ * @struct Options
+ * @brief How inputs are compiled.
+ */
+struct Options {
+    std::string optimizationLevel; ///< "" = leave the IR as generated
+    bool verbose = false;          ///< Print the IR of every input
+};
+
+/**
+ * @brief Reads, compiles and runs input from stdin until end of file or `:quit`.
+ * @return Exit status of gigly.
+ */
+int run(const Options& options);
+
+} // namespace repl
+
+#endif // REPL_HPP
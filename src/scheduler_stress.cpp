@@ -0,0 +1,149 @@
+/**
+ * @file scheduler_stress.cpp
+ * @brief Stress test of ThreadPool and BuildScheduler, run by ctest and `make test`.
+ *
+ * Runs a deep and wide import DAG many times on several workers and checks that
+ * every file is built exactly once, only after everything it imports, and that
+ * run() returns only once no build is running anymore. A task that throws must
+ * reach the caller after the pool drained, and tasks submitted from a worker
+ * must be waited for even when another worker runs them at once.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "build_graph.hpp"
+#include "include/cli11.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+// `depth` layers of `width` files; every file imports up to `fanIn` files of the layer below
+buildGraph::ImportGraph makeGraph(size_t depth, size_t width, size_t fanIn, std::mt19937& random) {
+    buildGraph::ImportGraph graph;
+    for (size_t layer = 0; layer < depth; ++layer) {
+        for (size_t column = 0; column < width; ++column) graph.addFile("l" + std::to_string(layer) + "/f" + std::to_string(column) + ".gc");
+    }
+    for (size_t layer = 1; layer < depth; ++layer) {
+        for (size_t column = 0; column < width; ++column) {
+            size_t importer = layer * width + column;
+            for (size_t edge = 0; edge < fanIn; ++edge) graph.addImport(importer, (layer - 1) * width + random() % width);
+        }
+    }
+    graph.computePriorities();
+    return graph;
+}
+
+// Busy work of a random length, so workers interleave differently every round
+void spin(unsigned iterations) {
+    std::atomic<unsigned> sink = 0;
+    for (unsigned idx = 0; idx < iterations; ++idx) sink += idx;
+    if (iterations % 7 == 0) std::this_thread::yield();
+}
+
+/**
+ * @brief One run of the scheduler over `graph`.
+ * @return The first broken rule, or "" if the run was correct.
+ */
+std::string checkRun(const buildGraph::ImportGraph& graph, buildGraph::ThreadPool& pool, unsigned seed) {
+    auto builds = std::make_unique<std::atomic<unsigned>[]>(graph.size());
+    auto finished = std::make_unique<std::atomic<bool>[]>(graph.size());
+    for (size_t idx = 0; idx < graph.size(); ++idx) {
+        builds[idx] = 0;
+        finished[idx] = false;
+    }
+    std::atomic<size_t> running = 0;
+    std::atomic<bool> earlyStart = false;
+
+    buildGraph::BuildScheduler scheduler(graph, pool);
+    auto neverStarted = scheduler.run([&](size_t idx) {
+        running++;
+        builds[idx]++;
+        for (size_t imported : graph[idx].imports) {
+            if (!finished[imported]) earlyStart = true;
+        }
+        spin((seed * 2654435761u + idx * 40503u) % 2000);
+        finished[idx] = true;
+        running--;
+    });
+
+    if (running != 0) return "run() returned while " + std::to_string(running.load()) + " build(s) were still running";
+    if (!neverStarted.empty()) return std::to_string(neverStarted.size()) + " file(s) never started";
+    if (earlyStart) return "a file was built before one of its imports finished";
+    for (size_t idx = 0; idx < graph.size(); ++idx) {
+        if (builds[idx] != 1) return graph[idx].relative.string() + " was built " + std::to_string(builds[idx].load()) + " times";
+    }
+    return "";
+}
+
+// Empty tasks submitted from inside a task, where a worker can pop & finish one at once:
+// wait() must not return before the submitting task and everything it submitted are done
+std::string checkNestedSubmits(buildGraph::ThreadPool& pool, unsigned tasks) {
+    std::atomic<unsigned> done = 0;
+    std::atomic<bool> submitting = true;
+    pool.submit([&]() {
+        for (unsigned idx = 0; idx < tasks; ++idx) pool.submit([&done]() { done++; });
+        submitting = false;
+    });
+    pool.wait();
+    if (submitting) return "wait() returned while a task was still submitting";
+    if (done != tasks) return "wait() returned after " + std::to_string(done.load()) + " of " + std::to_string(tasks) + " tasks";
+    return "";
+}
+
+// A throwing build must not end wait() before the other builds are done
+std::string checkThrow(const buildGraph::ImportGraph& graph, buildGraph::ThreadPool& pool) {
+    std::atomic<size_t> running = 0;
+    buildGraph::BuildScheduler scheduler(graph, pool);
+    try {
+        scheduler.run([&](size_t idx) {
+            running++;
+            spin(static_cast<unsigned>(idx % 500));
+            running--;
+            if (idx == graph.size() / 2) throw std::runtime_error("build failed");
+        });
+    } catch (const std::runtime_error&) {
+        if (running != 0) return "the exception reached the caller while builds were still running";
+        return "";
+    }
+    return "the exception of a build was lost";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CLI::App app{"GigglyCode Build Scheduler Stress Test"};
+
+    unsigned jobs = 16;
+    unsigned rounds = 1000;
+    size_t depth = 24;
+    size_t width = 32;
+    size_t fanIn = 3;
+    app.add_option("-j,--jobs", jobs, "Workers of the pool; more than the cores, so they are preempted mid-submit")->default_val(16)->check(CLI::Range(2u, 256u));
+    app.add_option("--rounds", rounds, "Runs of the scheduler")->default_val(1000);
+    app.add_option("--depth", depth, "Layers of the graph")->default_val(24);
+    app.add_option("--width", width, "Files per layer")->default_val(32);
+    app.add_option("--fan-in", fanIn, "Imports per file")->default_val(3);
+    CLI11_PARSE(app, argc, argv);
+
+    std::mt19937 random(12345);
+    auto graph = makeGraph(depth, width, fanIn, random);
+    buildGraph::ThreadPool pool(jobs);
+
+    for (unsigned round = 0; round < rounds; ++round) {
+        std::string failure = checkNestedSubmits(pool, 2000);
+        if (failure.empty()) failure = round % 10 == 9 ? checkThrow(graph, pool) : checkRun(graph, pool, round);
+        if (!failure.empty()) {
+            std::cerr << "Round " << round << ": " << failure << std::endl;
+            return 1;
+        }
+    }
+    std::cout << rounds << " rounds of " << graph.size() << " files on " << jobs << " workers passed" << std::endl;
+    return 0;
+}
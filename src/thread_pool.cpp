@@ -0,0 +1,123 @@
+#include "thread_pool.hpp"
+
+namespace buildGraph {
+
+// Index of the pool worker running on this thread, or -1 on any other thread.
+static thread_local int current_worker = -1;
+static thread_local ThreadPool* current_pool = nullptr;
+
+unsigned ThreadPool::defaultJobs() {
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+ThreadPool::ThreadPool(unsigned jobs) : jobserver(Jobserver::instance()) {
+    if (jobs == 0) jobs = defaultJobs();
+    for (unsigned i = 0; i < jobs; ++i) { queues.push_back(std::make_unique<WorkerQueue>()); }
+    for (unsigned i = 0; i < jobs; ++i) {
+        workers.emplace_back([this, i]() { _workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    wake_cv.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) { worker.join(); }
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    unsigned index = (current_pool == this && current_worker >= 0) ? static_cast<unsigned>(current_worker) : next_queue++ % queues.size();
+    // Counted before it is published: a worker may pop & finish the task before this thread runs again
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        queued++;
+        pending++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wake_cv.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    done_cv.wait(lock, [this]() { return pending == 0; });
+    if (first_error) {
+        auto error = first_error;
+        first_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::_popOrSteal(unsigned index, Task& task) {
+    // Own deque first, newest task first
+    {
+        auto& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // Then steal the oldest task from the other workers
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        auto& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<char> ThreadPool::_acquireToken() {
+    // Polled, so a worker waiting on make notices when the work is gone
+    while (true) {
+        if (auto token = jobserver->acquire(std::chrono::milliseconds(50))) return token;
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (stopping || queued == 0) return std::nullopt;
+    }
+}
+
+void ThreadPool::_workerLoop(unsigned index) {
+    current_worker = static_cast<int>(index);
+    current_pool = this;
+    // The first worker runs on the job slot make gave gigly
+    bool limited = jobserver && index > 0;
+    while (true) {
+        std::optional<char> token;
+        if (limited) token = _acquireToken();
+        Task task;
+        if ((!limited || token) && _popOrSteal(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                queued--;
+            }
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (!first_error) first_error = std::current_exception();
+            }
+            if (token) jobserver->release(*token);
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (--pending == 0) done_cv.notify_all();
+            continue;
+        }
+        if (token) jobserver->release(*token);
+        std::unique_lock<std::mutex> lock(state_mutex);
+        wake_cv.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
+
+} // namespace buildGraph
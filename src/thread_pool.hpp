@@ -0,0 +1,98 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+/**
+ * @file thread_pool.hpp
+ * @brief Fixed-size work-stealing thread pool used by the build driver.
+ *
+ * Every worker owns a deque of tasks. Tasks submitted from inside a worker are
+ * pushed onto that worker's own deque and popped LIFO, which keeps a chain of
+ * dependent files on the same core. Idle workers steal FIFO from the other
+ * deques so no core sits idle while work is queued elsewhere.
+ *
+ * Under a GNU make jobserver the first worker runs on the job slot make gave
+ * gigly; every other worker takes a token from make before each task and
+ * hands it back after, so the workers never exceed the budget of the build.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "jobserver.hpp"
+
+namespace buildGraph {
+
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Starts the worker threads.
+     * @param jobs Number of workers. 0 means one worker per hardware thread.
+     */
+    explicit ThreadPool(unsigned jobs = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queues a task. Tasks queued from a worker go onto that worker's deque.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Blocks until every queued and running task has finished.
+     *
+     * Rethrows the first exception raised by a task, if any.
+     */
+    void wait();
+
+    /**
+     * @brief Number of worker threads.
+     */
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    /**
+     * @brief Returns the default worker count (the number of hardware threads).
+     */
+    static unsigned defaultJobs();
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex state_mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable done_cv;
+    size_t queued = 0;  ///< Tasks sitting in a deque
+    size_t pending = 0; ///< Tasks queued or running
+    bool stopping = false;
+    std::atomic<unsigned> next_queue = 0; ///< Round-robin slot for external submits
+
+    std::exception_ptr first_error = nullptr;
+
+    Jobserver* jobserver = nullptr; ///< Limits the workers besides the first; null = no limit
+
+    bool _popOrSteal(unsigned index, Task& task);
+    std::optional<char> _acquireToken();
+    void _workerLoop(unsigned index);
+};
+
+} // namespace buildGraph
+
+#endif // THREAD_POOL_HPP
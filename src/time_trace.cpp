@@ -0,0 +1,131 @@
+#include "time_trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace timeTrace {
+
+std::atomic<bool> recording = false;
+
+namespace {
+
+struct Event {
+    const char* name;
+    std::string detail;
+    int64_t start_us; // Since enable()
+    int64_t duration_us;
+    unsigned thread;
+};
+
+std::mutex events_mutex;
+std::vector<Event> events;
+std::chrono::steady_clock::time_point trace_start;
+std::atomic<unsigned> next_thread = 0;
+
+// Small, stable ids read better in the trace viewer than std::thread::id
+unsigned threadIndex() {
+    thread_local unsigned index = next_thread++;
+    return index;
+}
+
+std::string escapeJSON(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+// Total time & count per detail of the events called `name`, slowest first
+std::vector<std::pair<std::string, std::pair<int64_t, size_t>>> slowest(const char* name, size_t top) {
+    std::unordered_map<std::string, std::pair<int64_t, size_t>> totals;
+    for (const auto& event : events) {
+        if (std::string(event.name) != name) continue;
+        auto& total = totals[event.detail];
+        total.first += event.duration_us;
+        total.second++;
+    }
+    std::vector<std::pair<std::string, std::pair<int64_t, size_t>>> sorted(totals.begin(), totals.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second.first != b.second.first ? a.second.first > b.second.first : a.first < b.first; });
+    if (sorted.size() > top) sorted.resize(top);
+    return sorted;
+}
+
+} // namespace
+
+void enable() {
+    std::lock_guard<std::mutex> lock(events_mutex);
+    trace_start = std::chrono::steady_clock::now();
+    events.clear();
+    recording = true;
+}
+
+Scope::~Scope() {
+    if (!active) return;
+    auto end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(events_mutex);
+    events.push_back({name,
+                      std::move(detail),
+                      std::chrono::duration_cast<std::chrono::microseconds>(start - trace_start).count(),
+                      std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                      threadIndex()});
+}
+
+bool writeChromeTrace(const std::filesystem::path& path, const std::string& process) {
+    std::lock_guard<std::mutex> lock(events_mutex);
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    unsigned threads = 0;
+    out << "{\"traceEvents\":[\n";
+    for (const auto& event : events) {
+        out << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us << ",\"name\":\"" << escapeJSON(event.name) << "\"";
+        if (!event.detail.empty()) out << ",\"args\":{\"detail\":\"" << escapeJSON(event.detail) << "\"}";
+        out << "},\n";
+        threads = std::max(threads, event.thread + 1);
+    }
+    for (unsigned thread = 0; thread < threads; ++thread) {
+        out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"name\":\"thread_name\",\"args\":{\"name\":\"thread " << thread << "\"}},\n";
+    }
+    out << "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"" << escapeJSON(process) << "\"}}\n";
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
+
+void printSummary(std::ostream& out, size_t top) {
+    std::lock_guard<std::mutex> lock(events_mutex);
+    auto print = [&](const char* title, const char* name) {
+        auto rows = slowest(name, top);
+        if (rows.empty()) return;
+        out << title << ":\n";
+        for (const auto& [detail, total] : rows) {
+            out << "  " << std::setw(10) << std::fixed << std::setprecision(2) << total.first / 1000.0 << " ms  " << detail;
+            if (total.second > 1) out << " (x" << total.second << ")";
+            out << "\n";
+        }
+    };
+    print("Slowest files", COMPILE_FILE);
+    print("Slowest functions", CODEGEN_FUNCTION);
+    out.flush();
+}
+
+} // namespace timeTrace
@@ -0,0 +1,76 @@
+#ifndef TIME_TRACE_HPP
+#define TIME_TRACE_HPP
+
+/**
+ * @file time_trace.hpp
+ * @brief Build timeline recorded by `--time-trace`.
+ *
+ * Scopes are recorded per thread and written as a Chrome trace (open it in
+ * chrome://tracing or https://ui.perfetto.dev). While tracing is off a Scope
+ * only checks an atomic flag.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <ostream>
+#include <string>
+
+namespace timeTrace {
+
+// Scope names the summary aggregates over
+inline constexpr const char* COMPILE_FILE = "Compile file";
+inline constexpr const char* CODEGEN_FUNCTION = "Codegen function";
+
+extern std::atomic<bool> recording;
+
+/**
+ * @brief Starts recording; scopes opened before this are not recorded.
+ */
+void enable();
+
+inline bool enabled() { return recording.load(std::memory_order_relaxed); }
+
+/**
+ * @class Scope
+ * @brief Records the time from its construction to its destruction.
+ */
+class Scope {
+  public:
+    /**
+     * @param name What is being done, e.g. "Parse"; events with the same name are compared in the summary.
+     * @param detail What it is done to, e.g. the file.
+     */
+    explicit Scope(const char* name, std::string detail = "") : active(enabled()) {
+        if (!active) return;
+        this->name = name;
+        this->detail = std::move(detail);
+        start = std::chrono::steady_clock::now();
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope();
+
+  private:
+    bool active;
+    const char* name = nullptr;
+    std::string detail;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Writes everything recorded so far as Chrome trace JSON.
+ * @param process Name the process is shown under.
+ * @return false if the file could not be written.
+ */
+bool writeChromeTrace(const std::filesystem::path& path, const std::string& process);
+
+/**
+ * @brief Prints the slowest files and functions recorded so far.
+ * @param top How many of each to list.
+ */
+void printSummary(std::ostream& out, size_t top);
+
+} // namespace timeTrace
+
+#endif // TIME_TRACE_HPP
@@ -0,0 +1,88 @@
+#include "watch.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace watch {
+
+// Directories need IN_CREATE & IN_MOVED_TO to follow new subdirectories
+static constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+
+SourceWatcher::SourceWatcher(const std::filesystem::path& root) : root(root) {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return;
+    watchTree(root, nullptr);
+    if (directories.empty()) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+SourceWatcher::~SourceWatcher() {
+    if (fd >= 0) close(fd);
+}
+
+void SourceWatcher::watchTree(const std::filesystem::path& directory, std::vector<std::filesystem::path>* found) {
+    int wd = inotify_add_watch(fd, directory.c_str(), WATCH_MASK);
+    if (wd < 0) return;
+    directories[wd] = directory;
+
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_directory(ec)) {
+            watchTree(it->path(), found);
+        } else if (found) {
+            // Files that arrived with a new directory were never seen by a watch
+            found->push_back(std::filesystem::relative(it->path(), root));
+        }
+    }
+}
+
+void SourceWatcher::readEvents(std::vector<std::filesystem::path>& changed) {
+    alignas(inotify_event) char buffer[64 * (sizeof(inotify_event) + NAME_MAX + 1)];
+    while (true) {
+        ssize_t size = read(fd, buffer, sizeof(buffer));
+        if (size < 0 && errno == EINTR) continue;
+        if (size <= 0) return;
+        for (char* cursor = buffer; cursor < buffer + size;) {
+            auto event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_IGNORED) {
+                directories.erase(event->wd);
+                continue;
+            }
+            auto directory = directories.find(event->wd);
+            if (directory == directories.end() || event->len == 0) continue;
+
+            std::filesystem::path path = directory->second / event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) watchTree(path, &changed);
+                continue;
+            }
+            changed.push_back(std::filesystem::relative(path, root));
+        }
+    }
+}
+
+std::vector<std::filesystem::path> SourceWatcher::wait(std::chrono::milliseconds quiet, std::chrono::milliseconds patience) {
+    std::vector<std::filesystem::path> changed;
+    pollfd request{fd, POLLIN, 0};
+    int timeout = patience.count() < 0 ? -1 : static_cast<int>(patience.count());
+    while (true) {
+        int ready = poll(&request, 1, timeout);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) break;
+        readEvents(changed);
+        timeout = static_cast<int>(quiet.count());
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+} // namespace watch
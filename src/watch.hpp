@@ -0,0 +1,57 @@
+#ifndef WATCH_HPP
+#define WATCH_HPP
+
+/**
+ * @file watch.hpp
+ * @brief inotify watcher over a source tree, used by `gigly --watch`.
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace watch {
+
+/**
+ * @class SourceWatcher
+ * @brief Reports the files created, written, moved or deleted under a directory.
+ *
+ * inotify is not recursive, so every directory of the tree gets its own watch;
+ * directories created later are picked up as they appear.
+ */
+class SourceWatcher {
+  public:
+    explicit SourceWatcher(const std::filesystem::path& root);
+    SourceWatcher(const SourceWatcher&) = delete;
+    SourceWatcher& operator=(const SourceWatcher&) = delete;
+    ~SourceWatcher();
+
+    /**
+     * @brief Whether the tree is (still) watched; false if inotify failed or the root was deleted.
+     */
+    bool valid() const { return fd >= 0 && !directories.empty(); }
+
+    /**
+     * @brief Blocks until something changes, then gathers changes until none arrive for `quiet`.
+     *
+     * Editors save in bursts (write a temporary, rename, touch), so the burst
+     * is returned as one batch.
+     * @param quiet How long the tree has to stay unchanged to end the batch.
+     * @param patience How long to wait for the first change; negative waits forever.
+     * @return Changed files relative to the root, sorted & unique; empty if `patience` ran out.
+     */
+    std::vector<std::filesystem::path> wait(std::chrono::milliseconds quiet = std::chrono::milliseconds(100), std::chrono::milliseconds patience = std::chrono::milliseconds(-1));
+
+  private:
+    void watchTree(const std::filesystem::path& directory, std::vector<std::filesystem::path>* found);
+    void readEvents(std::vector<std::filesystem::path>& changed);
+
+    int fd = -1;
+    std::filesystem::path root;
+    std::unordered_map<int, std::filesystem::path> directories; ///< Watch descriptor -> watched directory
+};
+
+} // namespace watch
+
+#endif // WATCH_HPP
@@ -6,6 +6,7 @@ import subprocess
 import difflib
 import argparse
 import re
+import tempfile
 
 # Colors
 GREEN = "\033[92m"
@@ -17,13 +18,33 @@ RESET = "\033[0m"
 def print_color(text, color):
     print(f"{color}{text}{RESET}")
 
-def run_command(cmd, capture_output=True):
+def run_command(cmd, capture_output=True, timeout=None):
     try:
-        res = subprocess.run(cmd, shell=True, capture_output=capture_output, text=True)
+        res = subprocess.run(cmd, shell=True, capture_output=capture_output, text=True, timeout=timeout)
         return res.returncode, res.stdout, res.stderr
+    except subprocess.TimeoutExpired:
+        # A hang (e.g. a deadlocked build) fails the test instead of stalling the run
+        return -1, "", f"Timed out after {timeout}s: {cmd}"
     except Exception as e:
         return -1, "", str(e)
 
+# Outputs a test compares; expected/checks.txt narrows them down for tests whose
+# expectations are written by hand, e.g. only "stdout"
+ALL_CHECKS = {"lexer", "parser", "ir", "stdout"}
+
+def get_checks(expected_dir):
+    content = get_file_content(os.path.join(expected_dir, "checks.txt"))
+    if content is None:
+        return set(ALL_CHECKS)
+    return set(content.split()) & ALL_CHECKS
+
+def missing_stderr_lines(expected_dir, sanitized_err):
+    """Lines of expected/stderr_contains.txt that are not in the sanitized stderr."""
+    content = get_file_content(os.path.join(expected_dir, "stderr_contains.txt"))
+    if content is None:
+        return []
+    return [line for line in content.splitlines() if line.strip() and line.strip() not in sanitized_err]
+
 def get_file_content(path):
     if not os.path.exists(path):
         return None
@@ -125,10 +146,287 @@ def diff_files(expected_path, actual_path):
     ))
     return "".join(diff)
 
+# ── Scenarios: checks that drive the tools other than by one build of a fixture ──
+
+def copy_fixture(project_root, folder):
+    """Copies a fixture's sources to a temporary test/ directory, so scenarios leave the tree alone
+    and the paths in their outputs still normalize like the fixture's."""
+    tmp = tempfile.mkdtemp(prefix="gigly-scenario-")
+    dest = os.path.join(tmp, "test", folder)
+    shutil.copytree(os.path.join(project_root, "test", folder), dest, ignore=shutil.ignore_patterns("build", "expected"))
+    return tmp, dest
+
+def scenario_multi_target(project_root, args):
+    """gigc --target a,b,...: each output matches the IR expected when compiling for that target alone."""
+    fixture = "test11"
+    gigc = os.path.join(project_root, "build", "gigc")
+    expected_ir = os.path.join(project_root, "test", fixture, "expected", "ir")
+    tmp, dest = copy_fixture(project_root, fixture)
+    try:
+        out_dir = os.path.join(tmp, "out")
+        cmd = f"{gigc} {dest}/src/main.gc -o {out_dir}/main.gc.ll --emit-llvm --target {','.join(args.cross_targets)}"
+        if args.verbose:
+            print(f"Running command: {cmd}")
+        ret, _, err = run_command(cmd, timeout=args.timeout)
+        if ret != 0:
+            return f"gigc failed with exit code {ret}: {err.strip()}"
+        for triple in args.cross_targets:
+            d = diff_files(os.path.join(expected_ir, get_normalized_triple(triple), "main.gc.ll"), os.path.join(out_dir, f"main.gc.{triple}.ll"))
+            if d:
+                return f"IR for '{triple}' differs from {fixture}'s expected IR:\n{d}"
+        return None
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+def build_fixture_copy(project_root, dest, args, flags=""):
+    """Builds a copied fixture with gigly -v, which reports how many files it rebuilt."""
+    gigly = os.path.join(project_root, "build", "gigly")
+    cmd = f"{gigly} {dest} -o {dest}/build/exec -v {flags}"
+    if args.verbose:
+        print(f"Running command: {cmd}")
+    return run_command(cmd, timeout=args.timeout)
+
+# Added to test12's module by the incremental rebuild scenario: a function & a generic struct whose
+# fields and method bodies go into the module's interface
+PAIR_STRUCT = """def twice(a: int) -> int {
+    return a + a;
+}
+
+@generic(T: Any)
+struct Pair {
+    first: T;
+    second: T;
+
+    def __init__(self: Pair[T], first: T, second: T) {
+        self.first = first;
+        self.second = second;
+    };
+
+    def sum(self: Pair[T]) -> T {
+        return self.first + self.second;
+    };
+};
+
+"""
+
+def scenario_incremental_rebuild(project_root, args):
+    """The build manifest skips unchanged files and keeps the executable when nothing changed;
+    a body-only edit of an import leaves its importers alone, as their interface hash is the same,
+    even when it moves the import's declarations to other lines."""
+    fixture = "test12"
+    expected_stdout = get_file_content(os.path.join(project_root, "test", fixture, "expected", "stdout.txt"))
+    tmp, dest = copy_fixture(project_root, fixture)
+    # (step, edit as (file under src/, old text, new text), rebuilt files gigly must report)
+    steps = [
+        ("first build", None, "2 of 2 file(s) rebuilt"),
+        ("no-op rebuild", None, "0 of 2 file(s) rebuilt"),
+        ("edit of the importer", ("main.gc", "return 0;", "return 0; # edited"), "1 of 2 file(s) rebuilt"),
+        ("body-only edit of the import", ("modules/math_utils.gc", "return a + b;", "return b + a;"), "1 of 2 file(s) rebuilt"),
+        ("interface edit of the import", ("modules/math_utils.gc", "def add(", PAIR_STRUCT + "def add("), "2 of 2 file(s) rebuilt"),
+        # Moves the generic struct, its fields & the operators in its method bodies a line down
+        ("line inserted above a struct of the import", ("modules/math_utils.gc", "@generic", "# Pairs\n@generic"), "1 of 2 file(s) rebuilt"),
+    ]
+    try:
+        for step, edit, rebuilt in steps:
+            if edit:
+                path = os.path.join(dest, "src", edit[0])
+                source = get_file_content(path)
+                with open(path, "w") as f:
+                    f.write(source.replace(edit[1], edit[2]))
+            ret, out, err = build_fixture_copy(project_root, dest, args)
+            if ret != 0:
+                return f"{step}: gigly failed with exit code {ret}: {err.strip()}"
+            if rebuilt not in out:
+                return f"{step}: expected '{rebuilt}' in gigly's output:\n{out}"
+            if step == "no-op rebuild" and "Executable is up to date" not in out:
+                return f"{step}: the executable was linked again:\n{out}"
+            exec_ret, exec_stdout, _ = run_command(os.path.join(dest, "build", "exec"), timeout=args.timeout)
+            if exec_ret != 0 or exec_stdout != expected_stdout:
+                return f"{step}: the executable printed {exec_stdout!r} with exit code {exec_ret}, expected {expected_stdout!r}"
+        return None
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+def scenario_emit_bitcode(project_root, args):
+    """gigly --emit-bc writes a bitcode file per source to build/bc, and no textual IR unless asked to."""
+    fixture = "test12"
+    expected_stdout = get_file_content(os.path.join(project_root, "test", fixture, "expected", "stdout.txt"))
+    tmp, dest = copy_fixture(project_root, fixture)
+    try:
+        ret, _, err = build_fixture_copy(project_root, dest, args, "--emit-bc")
+        if ret != 0:
+            return f"gigly failed with exit code {ret}: {err.strip()}"
+        for relative in ["main.gc", os.path.join("modules", "math_utils.gc")]:
+            bitcode = os.path.join(dest, "build", "bc", relative + ".bc")
+            if not os.path.exists(bitcode):
+                return f"no bitcode written for {relative}"
+            with open(bitcode, "rb") as f:
+                if f.read(4) != b"BC\xc0\xde":
+                    return f"{bitcode} is not LLVM bitcode"
+        if os.path.exists(os.path.join(dest, "build", "ir")):
+            return "textual IR was written without --emit-llvm"
+        exec_ret, exec_stdout, _ = run_command(os.path.join(dest, "build", "exec"), timeout=args.timeout)
+        if exec_ret != 0 or exec_stdout != expected_stdout:
+            return f"the executable printed {exec_stdout!r} with exit code {exec_ret}, expected {expected_stdout!r}"
+        return None
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+def check_executable(fixture, dest, args, expected_stdout):
+    """Runs the executable a copied fixture was built into; None if it printed the fixture's expected stdout."""
+    ret, stdout, _ = run_command(os.path.join(dest, "build", "exec"), timeout=args.timeout)
+    if ret != 0 or stdout != expected_stdout:
+        return f"{fixture}'s executable printed {stdout!r} with exit code {ret}, expected {expected_stdout!r}"
+    return None
+
+def scenario_lto(project_root, args):
+    """gigly --lto full|thin links executables that behave like the ones built without it."""
+    fixture = "test12"
+    expected_stdout = get_file_content(os.path.join(project_root, "test", fixture, "expected", "stdout.txt"))
+    for mode in ["full", "thin"]:
+        tmp, dest = copy_fixture(project_root, fixture)
+        try:
+            ret, _, err = build_fixture_copy(project_root, dest, args, f"--lto {mode}")
+            if ret != 0:
+                return f"--lto {mode}: gigly failed with exit code {ret}: {err.strip()}"
+            failure = check_executable(fixture, dest, args, expected_stdout)
+            if failure:
+                return f"--lto {mode}: {failure}"
+        finally:
+            shutil.rmtree(tmp, ignore_errors=True)
+    return None
+
+def scenario_unity(project_root, args):
+    """gigly --unity compiles a project with imports into one module that runs like the per-file build."""
+    fixture = "test12"
+    expected_stdout = get_file_content(os.path.join(project_root, "test", fixture, "expected", "stdout.txt"))
+    tmp, dest = copy_fixture(project_root, fixture)
+    try:
+        ret, _, err = build_fixture_copy(project_root, dest, args, "--unity")
+        if ret != 0:
+            return f"gigly failed with exit code {ret}: {err.strip()}"
+        return check_executable(fixture, dest, args, expected_stdout)
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+def scenario_object_cache(project_root, args):
+    """Two build directories share one --cache-dir: the second build restores every object and interface
+    from the cache, and a file compiled there later imports the restored interface."""
+    fixture = "test12"
+    expected_stdout = get_file_content(os.path.join(project_root, "test", fixture, "expected", "stdout.txt"))
+    cache_root = tempfile.mkdtemp(prefix="gigly-cache-")
+    copies = [copy_fixture(project_root, fixture) for _ in range(2)]
+    flags = f"--cache-dir {os.path.join(cache_root, 'cache')}"
+    # (step, copy built, edit of its main.gc as (old text, new text), what gigly must report)
+    steps = [
+        ("first build directory", 0, None, "Object cache: 0 hit(s), 2 miss(es)."),
+        ("second build directory", 1, None, "Object cache: 2 hit(s), 0 miss(es)."),
+        ("edit against a restored interface", 1, ("return 0;", "return 0; # edited"), "1 of 2 file(s) rebuilt"),
+    ]
+    try:
+        for step, copy, edit, reported in steps:
+            dest = copies[copy][1]
+            if edit:
+                path = os.path.join(dest, "src", "main.gc")
+                source = get_file_content(path)
+                with open(path, "w") as f:
+                    f.write(source.replace(edit[0], edit[1]))
+            ret, out, err = build_fixture_copy(project_root, dest, args, flags)
+            if ret != 0:
+                return f"{step}: gigly failed with exit code {ret}: {err.strip()}"
+            if reported not in out:
+                return f"{step}: expected '{reported}' in gigly's output:\n{out}"
+            failure = check_executable(fixture, dest, args, expected_stdout)
+            if failure:
+                return f"{step}: {failure}"
+        return None
+    finally:
+        for tmp, _ in copies:
+            shutil.rmtree(tmp, ignore_errors=True)
+        shutil.rmtree(cache_root, ignore_errors=True)
+
+def run_fixture_copy(project_root, dest, args, flags=""):
+    """Runs a copied fixture in the JIT with gigly run, which prints only what the program prints."""
+    gigly = os.path.join(project_root, "build", "gigly")
+    cmd = f"{gigly} run {flags} {dest}"
+    if args.verbose:
+        print(f"Running command: {cmd}")
+    return run_command(cmd, timeout=args.timeout)
+
+def scenario_jit_run(project_root, args):
+    """gigly run executes a project with imports in the JIT, printing what its executable prints, and writes no objects."""
+    fixture = "test12"
+    expected_stdout = get_file_content(os.path.join(project_root, "test", fixture, "expected", "stdout.txt"))
+    tmp, dest = copy_fixture(project_root, fixture)
+    try:
+        ret, out, err = run_fixture_copy(project_root, dest, args)
+        if ret != 0 or out != expected_stdout:
+            return f"gigly run printed {out!r} with exit code {ret}, expected {expected_stdout!r}: {err.strip()}"
+        for root, _, files in os.walk(os.path.join(dest, "build")):
+            objects = [f for f in files if f.endswith(".o")]
+            if objects:
+                return f"gigly run wrote object files to {root}: {', '.join(objects)}"
+        return None
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+def scenario_tiered_run(project_root, args):
+    """gigly run --tiered prints what the executable prints, with functions re-optimized from their first calls on."""
+    fixture = "test_big"
+    expected_stdout = get_file_content(os.path.join(project_root, "test", fixture, "expected", "stdout.txt"))
+    tmp, dest = copy_fixture(project_root, fixture)
+    try:
+        # A threshold of 1 swaps optimized code in while the program still runs
+        ret, out, err = run_fixture_copy(project_root, dest, args, "--tiered --tier-threshold 1")
+        if ret != 0 or out != expected_stdout:
+            return f"gigly run --tiered printed {out!r} with exit code {ret}, expected {expected_stdout!r}: {err.strip()}"
+        return None
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+def scenario_lexer_tokens(project_root, args):
+    """lexer_bench --tokens reproduces the token streams recorded in test/lexer, with and without --comments."""
+    lexer_bench = os.path.join(project_root, "build", "lexer_bench")
+    corpus = os.path.join(project_root, "test", "lexer")
+    for source in sorted(f for f in os.listdir(corpus) if f.endswith(".gc")):
+        for flags, suffix in (([], ".tokens"), (["--comments"], ".comments.tokens")):
+            # Compared as bytes: the sources hold \r, which text mode would translate
+            try:
+                res = subprocess.run([lexer_bench, "--tokens", *flags, os.path.join(corpus, source)], capture_output=True, timeout=args.timeout)
+            except (OSError, subprocess.TimeoutExpired) as e:
+                return f"lexer_bench failed on {source}: {e}"
+            if res.returncode != 0:
+                return f"lexer_bench failed on {source} with exit code {res.returncode}: {res.stderr.decode(errors='replace').strip()}"
+            expected_path = os.path.join(corpus, source[:-len(".gc")] + suffix)
+            with open(expected_path, "rb") as f:
+                expected = f.read()
+            if res.stdout != expected:
+                diff = "".join(difflib.unified_diff(
+                    expected.decode(errors="replace").splitlines(keepends=True),
+                    res.stdout.decode(errors="replace").splitlines(keepends=True),
+                    fromfile=expected_path,
+                    tofile=f"lexer_bench --tokens {' '.join(flags)} {source}",
+                ))
+                return f"token stream of {source} changed:\n{diff}"
+    return None
+
+SCENARIOS = [
+    ("gigc_multi_target", scenario_multi_target),
+    ("incremental_rebuild", scenario_incremental_rebuild),
+    ("emit_bitcode", scenario_emit_bitcode),
+    ("lto", scenario_lto),
+    ("unity", scenario_unity),
+    ("object_cache", scenario_object_cache),
+    ("jit_run", scenario_jit_run),
+    ("tiered_run", scenario_tiered_run),
+    ("lexer_tokens", scenario_lexer_tokens),
+]
+
 def main():
     parser = argparse.ArgumentParser(description="GigglyCode Test Runner")
     parser.add_argument("-g", "--generate", action="store_true", help="Generate/Update ground truth (expected) files")
     parser.add_argument("-v", "--verbose", action="store_true", help="Verbose output")
+    parser.add_argument("--timeout", type=int, default=120, help="Seconds a compile or run may take before the test fails")
     parser.add_argument(
         "--cross-targets",
         nargs="+",
@@ -174,11 +472,12 @@ def main():
 
         # 1. Compile
         exec_path = os.path.join(build_dir, "exec")
-        compile_cmd = f"{compiler_bin} {folder_path} -o {exec_path}"
+        compile_cmd = f"{compiler_bin} {folder_path} -o {exec_path} --emit-llvm"
         if args.verbose:
             print(f"Running command: {compile_cmd}")
             
-        ret_code, stdout, stderr = run_command(compile_cmd)
+        ret_code, stdout, stderr = run_command(compile_cmd, timeout=args.timeout)
+        checks = get_checks(expected_dir)
         
         if is_fail_test:
             # Compiler should fail
@@ -188,14 +487,25 @@ def main():
                 continue
             
             sanitized_err = sanitize_stderr(stderr)
-            
-            if args.generate:
+            missing_lines = missing_stderr_lines(expected_dir, sanitized_err)
+            expected_stderr_path = os.path.join(expected_dir, "stderr.txt")
+            has_stderr_contains = os.path.exists(os.path.join(expected_dir, "stderr_contains.txt"))
+
+            if missing_lines:
+                print_color(f"[{folder}] FAILED: Compilation failed, but stderr lacks:", RED)
+                for line in missing_lines:
+                    print(f"  {line}")
+                print(sanitized_err)
+                failed_tests.append(folder)
+            elif has_stderr_contains and not os.path.exists(expected_stderr_path):
+                print_color(f"[{folder}] PASSED: Compilation failed as expected with the expected errors.", GREEN)
+                passed_tests.append(folder)
+            elif args.generate:
                 with open(os.path.join(expected_dir, "stderr.txt"), "w") as f:
                     f.write(sanitized_err)
                 print_color(f"[{folder}] Stderr generated.", GREEN)
                 passed_tests.append(folder)
             else:
-                expected_stderr_path = os.path.join(expected_dir, "stderr.txt")
                 if not os.path.exists(expected_stderr_path):
                     print_color(f"[{folder}] FAILED: No expected/stderr.txt found.", RED)
                     failed_tests.append(folder)
@@ -230,8 +540,15 @@ def main():
         ir_dir      = os.path.join(build_dir, "ir")         # whole IR tree
         main_ll     = os.path.join(ir_dir, "main.gc.ll")    # used only for triple extraction
 
+        # The compiler's own warnings, e.g. on import cycles
+        missing_lines = missing_stderr_lines(expected_dir, sanitize_stderr(stderr))
+        if missing_lines:
+            print_color(f"[{folder}] FAILED: Compiler stderr lacks: {'; '.join(missing_lines)}", RED)
+            failed_tests.append(folder)
+            continue
+
         # Check that compiler outputs exist
-        if not os.path.exists(lexer_log) or not os.path.exists(parser_yaml) or not os.path.exists(main_ll):
+        if ("lexer" in checks and not os.path.exists(lexer_log)) or ("parser" in checks and not os.path.exists(parser_yaml)) or not os.path.exists(main_ll):
             print_color(f"[{folder}] FAILED: Missing output files in build directory.", RED)
             failed_tests.append(folder)
             continue
@@ -240,7 +557,7 @@ def main():
         run_cmd_str = exec_path
         if args.verbose:
             print(f"Running executable: {run_cmd_str}")
-        exec_ret, exec_stdout, exec_stderr = run_command(run_cmd_str)
+        exec_ret, exec_stdout, exec_stderr = run_command(run_cmd_str, timeout=args.timeout)
 
         # 3. Extract target triple from main.gc.ll
         target_triple = None
@@ -288,15 +605,19 @@ def main():
         if args.generate:
             # ── 1. Native target: capture IR + stdout + shared files ──────────
             # Wipe and rebuild the target IR tree so stale files are removed
-            if os.path.exists(target_ir_dir):
-                shutil.rmtree(target_ir_dir)
-            shutil.copytree(ir_dir, target_ir_dir)
+            if "ir" in checks:
+                if os.path.exists(target_ir_dir):
+                    shutil.rmtree(target_ir_dir)
+                shutil.copytree(ir_dir, target_ir_dir)
 
             # target-independent files at root expected/
-            shutil.copy(lexer_log,   os.path.join(expected_dir, "lexer_output.log"))
-            shutil.copy(parser_yaml, os.path.join(expected_dir, "parser_output.yaml"))
-            with open(stdout_expected, "w") as f:
-                f.write(exec_stdout)
+            if "lexer" in checks:
+                shutil.copy(lexer_log,   os.path.join(expected_dir, "lexer_output.log"))
+            if "parser" in checks:
+                shutil.copy(parser_yaml, os.path.join(expected_dir, "parser_output.yaml"))
+            if "stdout" in checks:
+                with open(stdout_expected, "w") as f:
+                    f.write(exec_stdout)
 
             ll_list = "\n    ".join(actual_ll_files)
             print_color(
@@ -308,17 +629,17 @@ def main():
             )
 
             # ── 2. Cross-targets: only IR (no execution possible) ─────────────
-            for cross_triple in args.cross_targets:
+            for cross_triple in (args.cross_targets if "ir" in checks else []):
                 cross_build_ir = os.path.join(build_dir, f"ir_cross_{cross_triple.replace('-', '_')}")
                 cross_compile_cmd = (
                     f"{compiler_bin} {folder_path} -o {exec_path}"
-                    f" --target {cross_triple}"
+                    f" --emit-llvm --target {cross_triple}"
                 )
                 if args.verbose:
                     print(f"  Cross-compiling for {cross_triple}: {cross_compile_cmd}")
 
                 # Recompile with overridden target (IR-only; we discard the linked exec)
-                c_ret, _, c_err = run_command(cross_compile_cmd)
+                c_ret, _, c_err = run_command(cross_compile_cmd, timeout=args.timeout)
                 if c_ret != 0:
                     print_color(
                         f"  [cross:{cross_triple}] FAILED to compile: {c_err.strip()}",
@@ -352,7 +673,7 @@ def main():
             passed_tests.append(folder)
         else:
             # ── Hard-fail when no IR tree exists for this target ──────────────
-            if not os.path.exists(target_ir_dir):
+            if "ir" in checks and not os.path.exists(target_ir_dir):
                 print_color(
                     f"[{folder}] SKIPPED / NO EXPECTED IR for target '{target_triple}' (normalized: '{target_norm}').\n"
                     f"  Expected IR directory not found: expected/ir/{target_norm}/\n"
@@ -366,15 +687,14 @@ def main():
                 continue
 
             # ── Compare all .ll files ─────────────────────────────────────────
-            lexer_diff  = diff_files(os.path.join(expected_dir, "lexer_output.log"), lexer_log)
-            parser_diff = diff_files(os.path.join(expected_dir, "parser_output.yaml"), parser_yaml)
+            lexer_diff  = diff_files(os.path.join(expected_dir, "lexer_output.log"), lexer_log) if "lexer" in checks else None
+            parser_diff = diff_files(os.path.join(expected_dir, "parser_output.yaml"), parser_yaml) if "parser" in checks else None
 
             ll_diffs = {}   # rel_path -> diff string
             # Check every expected IR file still matches
-            for rel in sorted(os.listdir(target_ir_dir) and
-                              [os.path.relpath(os.path.join(r, f), target_ir_dir)
+            for rel in sorted([os.path.relpath(os.path.join(r, f), target_ir_dir)
                                for r, _, fs in os.walk(target_ir_dir) for f in fs
-                               if f.endswith(".ll")]):
+                               if f.endswith(".ll")] if "ir" in checks else []):
                 expected_ll = os.path.join(target_ir_dir, rel)
                 actual_ll   = os.path.join(ir_dir, rel)
                 d = diff_files(expected_ll, actual_ll)
@@ -385,12 +705,12 @@ def main():
                 os.path.relpath(os.path.join(r, f), target_ir_dir)
                 for r, _, fs in os.walk(target_ir_dir) for f in fs if f.endswith(".ll")
             )
-            for rel in actual_ll_files:
+            for rel in (actual_ll_files if "ir" in checks else []):
                 if rel not in expected_rels and rel not in ll_diffs:
                     ll_diffs[rel] = f"NEW FILE not in expected: {rel}"
 
             # stdout is target-independent
-            expected_stdout_content = get_file_content(stdout_expected)
+            expected_stdout_content = get_file_content(stdout_expected) if "stdout" in checks else None
             stdout_diff = None
             if expected_stdout_content is not None:
                 if expected_stdout_content != exec_stdout:
@@ -431,7 +751,7 @@ def main():
 
             # ── Cross-targets validation ──────────────────────────────────────
             cross_ll_diffs_all = {}
-            for cross_triple in args.cross_targets:
+            for cross_triple in (args.cross_targets if "ir" in checks else []):
                 cross_norm = get_normalized_triple(cross_triple)
                 cross_expected_ir = os.path.join(expected_dir, "ir", cross_norm)
                 if not os.path.exists(cross_expected_ir):
@@ -441,12 +761,12 @@ def main():
                 # Run the compiler for the cross-target
                 cross_compile_cmd = (
                     f"{compiler_bin} {folder_path} -o {exec_path}"
-                    f" --target {cross_triple}"
+                    f" --emit-llvm --target {cross_triple}"
                 )
                 if args.verbose:
                     print(f"  Testing cross-target {cross_triple}: {cross_compile_cmd}")
 
-                c_ret, _, c_err = run_command(cross_compile_cmd)
+                c_ret, _, c_err = run_command(cross_compile_cmd, timeout=args.timeout)
                 if c_ret != 0:
                     failed_reasons.append(f"cross-compilation for target '{cross_triple}' failed with: {c_err.strip()}")
                     continue
@@ -518,7 +838,7 @@ def main():
                 failed_tests.append(folder)
             else:
                 ir_count = len(actual_ll_files)
-                cross_msg = f", {len(args.cross_targets)} cross-target(s)" if args.cross_targets else ""
+                cross_msg = f", {len(args.cross_targets)} cross-target(s)" if args.cross_targets and "ir" in checks else ""
                 print_color(
                     f"[{folder}] PASSED: All outputs match "
                     f"(target: {target_triple}{cross_msg}, {ir_count} IR file(s)).",
@@ -526,10 +846,22 @@ def main():
                 )
                 passed_tests.append(folder)
 
+    # Scenarios compare against the fixtures' ground truth, so they do not run while it is generated
+    for name, scenario in ([] if args.generate else SCENARIOS):
+        print_color(f"\n--- Running scenario: {name} ---", BLUE)
+        failure = scenario(project_root, args)
+        if failure:
+            print_color(f"[{name}] FAILED: {failure}", RED)
+            failed_tests.append(name)
+        else:
+            print_color(f"[{name}] PASSED", GREEN)
+            passed_tests.append(name)
+
+    total = len(passed_tests) + len(failed_tests)
     print("\n================ TEST SUMMARY ================")
-    print_color(f"Passed: {len(passed_tests)}/{len(test_folders)}", GREEN if len(passed_tests) == len(test_folders) else YELLOW)
+    print_color(f"Passed: {len(passed_tests)}/{total}", GREEN if not failed_tests else YELLOW)
     if failed_tests:
-        print_color(f"Failed: {len(failed_tests)}/{len(test_folders)} ({', '.join(failed_tests)})", RED)
+        print_color(f"Failed: {len(failed_tests)}/{total} ({', '.join(failed_tests)})", RED)
         sys.exit(1)
     else:
         print_color("All tests passed successfully!", GREEN)